@@ -48,3 +48,7 @@ class SoundsConan(ConanFile):
 
     python_requires="shred_conan_base/0.0.5@adnn/stable"
     python_requires_extend="shred_conan_base.ShredBaseConanFile"
+
+    def requirements(self):
+        if self.options.build_tests:
+            self.requires("catch2/2.13.9")
@@ -25,10 +25,16 @@ int main()
     ad::sounds::SoundManager manager{{SoundCategory_SFX, SoundCategory_Music, SoundCategory_Dialog}};
 
     /*ad::handy::StringId testId = manager.createStreamedOggData("test.ogg");*/
-    /*ad::handy::StringId testmono =*/ manager.createStreamedOggData("testmono.ogg");
-    ad::handy::StringId ahouaismono = manager.createData("ahouaismono.ogg");
-    ad::handy::StringId ahouaismonocourt = manager.createData("ahouaismonocourt.ogg");
-    /*ad::handy::StringId ahouais =*/ manager.createStreamedOggData("ahouais.ogg");
+    ad::sounds::PreloadStats preloadStats = manager.preloadSounds({
+            {"testmono.ogg", true},
+            {"ahouaismono.ogg"},
+            {"ahouaismonocourt.ogg"},
+            {"ahouais.ogg", true},
+            });
+    /*ad::handy::StringId testmono = preloadStats.soundIds[0];*/
+    ad::handy::StringId ahouaismono = preloadStats.soundIds[1];
+    ad::handy::StringId ahouaismonocourt = preloadStats.soundIds[2];
+    /*ad::handy::StringId ahouais = preloadStats.soundIds[3];*/
     /* ad::sounds::Handle<ad::sounds::SoundCue> testHandle = manager.createSoundCue( */
     /*         {{ahouaismono, {3}}}, */
     /*         SoundCategory_Music, */
@@ -74,19 +80,20 @@ int main()
     bool interrupted = false;
     while(true)
     {
-        ad::sounds::PlayingSoundCue * testCue = testCueHandle.toObject();
-        if (testCue != nullptr)
+        std::optional<ad::sounds::SoundOption> testOption = manager.getSoundOption(testCueHandle);
+        if (testOption.has_value())
         {
-            testCue->option.position.x() = R * cosf(OMEGA.value() * t);
-            testCue->option.position.y() = R * sinf(OMEGA.value() * t);
-            testCue->option.velocity.x() = R * -sinf(OMEGA.value() * t);
-            testCue->option.velocity.y() = R * cosf(OMEGA.value() * t);
+            testOption->position.x() = R * cosf(OMEGA.value() * t);
+            testOption->position.y() = R * sinf(OMEGA.value() * t);
+            testOption->velocity.x() = R * -sinf(OMEGA.value() * t);
+            testOption->velocity.y() = R * cosf(OMEGA.value() * t);
+            manager.setSoundOption(testCueHandle, *testOption);
             spdlog::get("sounds")->trace("t {}, omega {}, Position {}, {}, {}",
                     t,
                     OMEGA.value(),
-                    testCue->option.position.x(),
-                    testCue->option.position.y(),
-                    testCue->option.position.z()
+                    testOption->position.x(),
+                    testOption->position.y(),
+                    testOption->position.z()
                     );
             t += 0.016f;
 
@@ -0,0 +1,122 @@
+#include "BufferPool.h"
+
+#include "SoundUtilities.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ad {
+namespace sounds {
+
+StaticBuffer::StaticBuffer(const void * aData, std::size_t aSize, ALenum aFormat, ALsizei aSampleRate) :
+    mSize{aSize}
+{
+    alCall(alGenBuffers, 1, &mBuffer);
+    alCall(alBufferData, mBuffer, aFormat, aData, static_cast<ALsizei>(aSize), aSampleRate);
+}
+
+StaticBuffer::~StaticBuffer()
+{
+    if (mBuffer != 0)
+    {
+        alCall(alDeleteBuffers, 1, &mBuffer);
+    }
+}
+
+StaticBuffer::StaticBuffer(StaticBuffer && aOther) noexcept :
+    mBuffer{std::exchange(aOther.mBuffer, 0)},
+    mSize{std::exchange(aOther.mSize, 0)}
+{}
+
+StaticBuffer & StaticBuffer::operator=(StaticBuffer && aOther) noexcept
+{
+    std::swap(mBuffer, aOther.mBuffer);
+    std::swap(mSize, aOther.mSize);
+    return *this;
+}
+
+BufferPool::~BufferPool()
+{
+    if (!mBuffers.empty())
+    {
+        spdlog::get("sounds")->warn("Buffer pool destroyed with {} buffers, they leak", mBuffers.size());
+    }
+}
+
+void BufferPool::reserve(std::size_t aSize)
+{
+    std::scoped_lock lock{mMutex};
+
+    if (aSize > mBuffers.size())
+    {
+        generate(aSize - mBuffers.size());
+    }
+}
+
+void BufferPool::clear()
+{
+    std::scoped_lock lock{mMutex};
+
+    if (mFreeBuffers.size() != mBuffers.size())
+    {
+        spdlog::get("sounds")->warn("Deleting {} buffers still in use", mBuffers.size() - mFreeBuffers.size());
+    }
+
+    alCall(alDeleteBuffers, static_cast<ALsizei>(mBuffers.size()), mBuffers.data());
+    mBuffers.clear();
+    mFreeBuffers.clear();
+}
+
+std::vector<ALuint> BufferPool::acquire(std::size_t aCount)
+{
+    std::scoped_lock lock{mMutex};
+
+    if (mFreeBuffers.size() < aCount)
+    {
+        spdlog::get("sounds")->warn(
+                "Buffer pool of {} buffers is exhausted, generating {} more",
+                mBuffers.size(), aCount - mFreeBuffers.size());
+        generate(aCount - mFreeBuffers.size());
+    }
+
+    std::vector<ALuint> buffers{mFreeBuffers.end() - aCount, mFreeBuffers.end()};
+    mFreeBuffers.resize(mFreeBuffers.size() - aCount);
+    mHighWaterMark = std::max(mHighWaterMark, mBuffers.size() - mFreeBuffers.size());
+    return buffers;
+}
+
+void BufferPool::release(const std::vector<ALuint> & aBuffers)
+{
+    std::scoped_lock lock{mMutex};
+    mFreeBuffers.insert(mFreeBuffers.end(), aBuffers.begin(), aBuffers.end());
+}
+
+std::size_t BufferPool::getSize() const
+{
+    std::scoped_lock lock{mMutex};
+    return mBuffers.size();
+}
+
+std::size_t BufferPool::getFreeCount() const
+{
+    std::scoped_lock lock{mMutex};
+    return mFreeBuffers.size();
+}
+
+std::size_t BufferPool::getHighWaterMark() const
+{
+    std::scoped_lock lock{mMutex};
+    return mHighWaterMark;
+}
+
+//Called with the mutex locked
+void BufferPool::generate(std::size_t aCount)
+{
+    std::vector<ALuint> buffers(aCount);
+    alCall(alGenBuffers, static_cast<ALsizei>(aCount), buffers.data());
+    mBuffers.insert(mBuffers.end(), buffers.begin(), buffers.end());
+    mFreeBuffers.insert(mFreeBuffers.end(), buffers.begin(), buffers.end());
+}
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <AL/al.h>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace ad {
+namespace sounds {
+
+//Owns an openAL buffer holding all the samples of a sound, deletes it when destroyed
+//It can be queued on several sources at once and is never written again
+class StaticBuffer
+{
+    public:
+        StaticBuffer() = default;
+        StaticBuffer(const void * aData, std::size_t aSize, ALenum aFormat, ALsizei aSampleRate);
+        ~StaticBuffer();
+
+        StaticBuffer(const StaticBuffer &) = delete;
+        StaticBuffer & operator=(const StaticBuffer &) = delete;
+        StaticBuffer(StaticBuffer && aOther) noexcept;
+        StaticBuffer & operator=(StaticBuffer && aOther) noexcept;
+
+        ALuint get() const
+        { return mBuffer; }
+
+        bool isValid() const
+        { return mBuffer != 0; }
+
+        //Bytes of samples uploaded to the buffer
+        std::size_t getSize() const
+        { return mSize; }
+
+    private:
+        ALuint mBuffer = 0;
+        std::size_t mSize = 0;
+};
+
+//OpenAL buffers shared by the playbacks so playing a sound does not generate buffers
+//The pool grows when it runs out, buffers are only deleted by clear().
+//Buffers are acquired when a voice gets a source and released when it loses it.
+//Both happen on the feeder thread when feeding is threaded,
+//on the thread calling update() and playSound otherwise
+class BufferPool
+{
+    public:
+        BufferPool() = default;
+        ~BufferPool();
+
+        BufferPool(const BufferPool &) = delete;
+        BufferPool & operator=(const BufferPool &) = delete;
+
+        //Generates buffers until the pool holds aSize of them
+        void reserve(std::size_t aSize);
+        //Deletes every buffer, they must not be queued on a source anymore
+        void clear();
+
+        std::vector<ALuint> acquire(std::size_t aCount);
+        void release(const std::vector<ALuint> & aBuffers);
+
+        //Number of buffers generated by the pool
+        std::size_t getSize() const;
+        std::size_t getFreeCount() const;
+        //Most buffers in use at once
+        std::size_t getHighWaterMark() const;
+
+    private:
+        void generate(std::size_t aCount);
+
+        std::vector<ALuint> mBuffers;
+        std::vector<ALuint> mFreeBuffers;
+        std::size_t mHighWaterMark = 0;
+        mutable std::mutex mMutex;
+};
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace ad {
+namespace sounds {
+
+//Lock-free single producer single consumer ring of commands
+//One thread only calls push, one thread only calls pop
+template<typename T, std::size_t N_capacity>
+class CommandQueue
+{
+    public:
+        bool push(T aCommand)
+        {
+            const std::size_t tail = mTail.load(std::memory_order_relaxed);
+            const std::size_t nextTail = (tail + 1) % mCommands.size();
+
+            if (nextTail == mHead.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            mCommands[tail] = std::move(aCommand);
+            mTail.store(nextTail, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T & aCommand)
+        {
+            const std::size_t head = mHead.load(std::memory_order_relaxed);
+
+            if (head == mTail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            aCommand = std::move(mCommands[head]);
+            //Release what the slot held on the consumer side
+            mCommands[head] = T{};
+            mHead.store((head + 1) % mCommands.size(), std::memory_order_release);
+            return true;
+        }
+
+    private:
+        //One slot is kept empty to tell a full ring from an empty one
+        std::array<T, N_capacity + 1> mCommands{};
+        std::atomic<std::size_t> mHead = 0;
+        std::atomic<std::size_t> mTail = 0;
+};
+
+} // namespace sounds
+} // namespace ad
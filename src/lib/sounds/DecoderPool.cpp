@@ -0,0 +1,68 @@
+#include "DecoderPool.h"
+
+namespace ad {
+namespace sounds {
+
+DecoderPool::DecoderPool(unsigned int aThreadCount)
+{
+    for (unsigned int i = 0; i < aThreadCount; i++)
+    {
+        mWorkers.emplace_back(&DecoderPool::work, this);
+    }
+}
+
+DecoderPool::~DecoderPool()
+{
+    {
+        std::scoped_lock lock{mJobsMutex};
+        mStopping = true;
+    }
+    mJobsCondition.notify_all();
+
+    for (std::thread & worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+void DecoderPool::push(std::function<void()> aJob)
+{
+    if (mWorkers.empty())
+    {
+        //No worker thread, the job is run synchronously
+        aJob();
+        return;
+    }
+
+    {
+        std::scoped_lock lock{mJobsMutex};
+        mJobs.push_back(std::move(aJob));
+    }
+    mJobsCondition.notify_one();
+}
+
+void DecoderPool::work()
+{
+    while (true)
+    {
+        std::function<void()> job;
+
+        {
+            std::unique_lock lock{mJobsMutex};
+            mJobsCondition.wait(lock, [this]{ return mStopping || !mJobs.empty(); });
+
+            if (mStopping)
+            {
+                return;
+            }
+
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+        }
+
+        job();
+    }
+}
+
+} // namespace sounds
+} // namespace ad
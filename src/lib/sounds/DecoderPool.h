@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ad {
+namespace sounds {
+
+//Pool of worker threads running decoding jobs outside of the game thread
+//Jobs are run in submission order, a job should not block on another job
+class DecoderPool
+{
+    public:
+        DecoderPool(unsigned int aThreadCount);
+        ~DecoderPool();
+
+        DecoderPool(const DecoderPool &) = delete;
+        DecoderPool & operator=(const DecoderPool &) = delete;
+
+        void push(std::function<void()> aJob);
+
+        std::size_t getThreadCount() const
+        { return mWorkers.size(); }
+
+    private:
+        void work();
+
+        std::deque<std::function<void()>> mJobs;
+        std::mutex mJobsMutex;
+        std::condition_variable mJobsCondition;
+        bool mStopping = false;
+
+        std::vector<std::thread> mWorkers;
+};
+
+} // namespace sounds
+} // namespace ad
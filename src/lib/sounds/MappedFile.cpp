@@ -0,0 +1,115 @@
+#include "MappedFile.h"
+
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ad {
+namespace sounds {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const filesystem::path & aPath)
+{
+    mFile = CreateFileW(aPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        mFile = nullptr;
+        spdlog::get("sounds")->error("Cannot open {} for mapping", aPath.string());
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0)
+    {
+        spdlog::get("sounds")->error("Cannot map empty file {}", aPath.string());
+        return;
+    }
+
+    mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mMapping == nullptr)
+    {
+        spdlog::get("sounds")->error("Cannot map {}: {}", aPath.string(), GetLastError());
+        return;
+    }
+
+    mData = static_cast<const char *>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+    if (mData == nullptr)
+    {
+        spdlog::get("sounds")->error("Cannot map {}: {}", aPath.string(), GetLastError());
+        return;
+    }
+    mSize = static_cast<std::size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping != nullptr)
+    {
+        CloseHandle(mMapping);
+    }
+    if (mFile != nullptr)
+    {
+        CloseHandle(mFile);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const filesystem::path & aPath)
+{
+    mFile = open(aPath.c_str(), O_RDONLY);
+    if (mFile == -1)
+    {
+        spdlog::get("sounds")->error("Cannot open {} for mapping", aPath.string());
+        return;
+    }
+
+    struct stat fileStat;
+    if (fstat(mFile, &fileStat) == -1 || fileStat.st_size == 0)
+    {
+        spdlog::get("sounds")->error("Cannot map empty file {}", aPath.string());
+        return;
+    }
+
+    void * data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, mFile, 0);
+    if (data == MAP_FAILED)
+    {
+        spdlog::get("sounds")->error("Cannot map {}", aPath.string());
+        return;
+    }
+
+    mData = static_cast<const char *>(data);
+    mSize = static_cast<std::size_t>(fileStat.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (mData != nullptr)
+    {
+        munmap(const_cast<char *>(mData), mSize);
+    }
+    if (mFile != -1)
+    {
+        close(mFile);
+    }
+}
+
+#endif
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <platform/Filesystem.h>
+
+#include <cstddef>
+#include <span>
+
+namespace ad {
+namespace sounds {
+
+//Read only mapping of a whole file in memory
+//The bytes are read from the page cache on access and shared with other processes
+class MappedFile
+{
+    public:
+        MappedFile(const filesystem::path & aPath);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile & operator=(const MappedFile &) = delete;
+
+        bool isOpen() const
+        { return mData != nullptr; }
+
+        std::span<const char> getBytes() const
+        { return {mData, mSize}; }
+
+    private:
+        const char * mData = nullptr;
+        std::size_t mSize = 0;
+#ifdef _WIN32
+        void * mFile = nullptr;
+        void * mMapping = nullptr;
+#else
+        int mFile = -1;
+#endif
+};
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,181 @@
+#include "PcmCache.h"
+
+#include "MappedFile.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ad {
+namespace sounds {
+
+namespace {
+
+//An entry is a header followed by the interleaved samples, in native byte order
+struct PcmCacheHeader
+{
+    std::array<char, 4> magic;
+    std::uint32_t version;
+    std::uint32_t channels;
+    std::uint32_t sampleRate;
+    std::uint64_t sampleCount;
+    std::uint32_t sampleFormat;
+    std::uint32_t reserved;
+    //Hash of the compressed data the samples were decoded from
+    std::uint64_t sourceHash;
+};
+
+constexpr std::array<char, 4> PCM_CACHE_MAGIC{'A', 'D', 'P', 'C'};
+constexpr std::uint32_t PCM_CACHE_VERSION = 3;
+
+filesystem::path getEntryPath(const filesystem::path & aDirectory, std::uint64_t aKey, SampleFormat aFormat)
+{
+    return aDirectory / fmt::format("{:016x}_{}.pcm", aKey, getSampleSize(aFormat) * 8);
+}
+
+std::uint64_t getProcessId()
+{
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return static_cast<std::uint64_t>(getpid());
+#endif
+}
+
+} // anonymous namespace
+
+//FNV-1a
+std::uint64_t hashContent(std::span<const char> aData)
+{
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (char byte : aData)
+    {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+bool readPcmCache(
+        const filesystem::path & aDirectory,
+        std::uint64_t aKey,
+        std::uint64_t aSourceHash,
+        SampleFormat aFormat,
+        CachedPcm & aPcm)
+{
+    filesystem::path entryPath = getEntryPath(aDirectory, aKey, aFormat);
+    std::error_code error;
+    if (!filesystem::exists(entryPath, error))
+    {
+        return false;
+    }
+
+    std::shared_ptr<MappedFile> entry = std::make_shared<MappedFile>(entryPath);
+    std::span<const char> bytes = entry->getBytes();
+    PcmCacheHeader header;
+
+    if (!entry->isOpen() || bytes.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    const std::size_t sampleSize = getSampleSize(aFormat);
+
+    if (header.magic != PCM_CACHE_MAGIC
+            || header.version != PCM_CACHE_VERSION
+            || header.sampleFormat != static_cast<std::uint32_t>(aFormat)
+            || (header.channels != 1 && header.channels != 2)
+            || header.sampleRate == 0
+            || bytes.size() - sizeof(header) != header.sampleCount * sampleSize)
+    {
+        spdlog::get("sounds")->warn("Ignoring damaged pcm cache entry {}", entryPath.string());
+        return false;
+    }
+
+    if (header.sourceHash != aSourceHash)
+    {
+        //The mapping is closed first, a mapped file cannot be removed on every platform
+        entry.reset();
+        spdlog::get("sounds")->info("Removing stale pcm cache entry {}", entryPath.string());
+        filesystem::remove(entryPath, error);
+        return false;
+    }
+
+    aPcm.channels = static_cast<int>(header.channels);
+    aPcm.sampleRate = header.sampleRate;
+    aPcm.sampleFormat = aFormat;
+    aPcm.samples = std::as_bytes(bytes.subspan(sizeof(header)));
+    aPcm.samplesOwner = std::move(entry);
+    return true;
+}
+
+void writePcmCache(
+        const filesystem::path & aDirectory,
+        std::uint64_t aKey,
+        std::uint64_t aSourceHash,
+        int aChannels,
+        unsigned int aSampleRate,
+        SampleFormat aFormat,
+        std::span<const std::byte> aSamples)
+{
+    std::error_code error;
+    filesystem::create_directories(aDirectory, error);
+
+    PcmCacheHeader header{
+        .magic = PCM_CACHE_MAGIC,
+        .version = PCM_CACHE_VERSION,
+        .channels = static_cast<std::uint32_t>(aChannels),
+        .sampleRate = aSampleRate,
+        .sampleCount = aSamples.size() / getSampleSize(aFormat),
+        .sampleFormat = static_cast<std::uint32_t>(aFormat),
+        .reserved = 0,
+        .sourceHash = aSourceHash,
+    };
+
+    //Written aside then renamed, so a concurrent reader never maps a partial entry
+    //The temporary name is unique to the writing thread among the processes sharing the directory
+    filesystem::path entryPath = getEntryPath(aDirectory, aKey, aFormat);
+    filesystem::path temporaryPath = entryPath;
+    temporaryPath += fmt::format(
+            ".{}.{}", getProcessId(), std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream entryStream{temporaryPath.string(), std::ios::binary};
+        entryStream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        entryStream.write(reinterpret_cast<const char *>(aSamples.data()), aSamples.size());
+
+        if (!entryStream)
+        {
+            spdlog::get("sounds")->warn("Cannot write pcm cache entry {}", entryPath.string());
+            entryStream.close();
+            filesystem::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    filesystem::rename(temporaryPath, entryPath, error);
+    if (error)
+    {
+        spdlog::get("sounds")->warn("Cannot write pcm cache entry {}: {}", entryPath.string(), error.message());
+        filesystem::remove(temporaryPath, error);
+    }
+}
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "SampleFormat.h"
+
+#include <platform/Filesystem.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace ad {
+namespace sounds {
+
+//Decoded samples of a non streamed sound stored on disk
+//Entries are keyed by the sound they were decoded from and hold a hash of its compressed data,
+//an entry whose sound changed since is removed when it is read, then written again
+struct CachedPcm
+{
+    int channels = 0;
+    unsigned int sampleRate = 0;
+    SampleFormat sampleFormat = SampleFormat_FLOAT32;
+    //Samples are read in place from the mapping of the entry
+    std::span<const std::byte> samples;
+    //Keeps samples alive
+    std::shared_ptr<const void> samplesOwner;
+};
+
+std::uint64_t hashContent(std::span<const char> aData);
+
+//Returns false on a miss, a damaged entry or a stale one
+//Each sample format of a sound is a separate entry
+bool readPcmCache(
+        const filesystem::path & aDirectory,
+        std::uint64_t aKey,
+        std::uint64_t aSourceHash,
+        SampleFormat aFormat,
+        CachedPcm & aPcm);
+//Samples are written from the caller's storage, they are not copied
+//A previous entry of the same key is replaced
+void writePcmCache(
+        const filesystem::path & aDirectory,
+        std::uint64_t aKey,
+        std::uint64_t aSourceHash,
+        int aChannels,
+        unsigned int aSampleRate,
+        SampleFormat aFormat,
+        std::span<const std::byte> aSamples);
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "SlotMap.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ad {
+namespace sounds {
+
+//Binary heap of handles with their priority stored inline, the greatest priority value is on top.
+//Positions are tracked by handle index, so erasing or reprioritizing a handle is O(log n)
+//and comparisons never resolve a handle
+template<typename T>
+class PriorityHeap
+{
+    public:
+        struct Entry
+        {
+            int priority;
+            Handle<T> handle;
+        };
+
+        void push(const Handle<T> & aHandle, int aPriority)
+        {
+            const std::size_t index = static_cast<std::size_t>(aHandle.mHandleIndex);
+            if (index >= mPositions.size())
+            {
+                mPositions.resize(index + 1, NOT_IN_HEAP);
+            }
+
+            mEntries.push_back({aPriority, aHandle});
+            mPositions[index] = mEntries.size() - 1;
+            siftUp(mEntries.size() - 1);
+        }
+
+        bool erase(const Handle<T> & aHandle)
+        {
+            const std::size_t position = find(aHandle);
+            if (position == NOT_IN_HEAP)
+            {
+                return false;
+            }
+
+            const std::size_t last = mEntries.size() - 1;
+            mPositions[static_cast<std::size_t>(aHandle.mHandleIndex)] = NOT_IN_HEAP;
+
+            if (position != last)
+            {
+                place(position, std::move(mEntries[last]));
+                mEntries.pop_back();
+                //The moved entry goes either up or down, never both
+                siftUp(position);
+                siftDown(position);
+            }
+            else
+            {
+                mEntries.pop_back();
+            }
+
+            return true;
+        }
+
+        bool setPriority(const Handle<T> & aHandle, int aPriority)
+        {
+            const std::size_t position = find(aHandle);
+            if (position == NOT_IN_HEAP)
+            {
+                return false;
+            }
+
+            mEntries[position].priority = aPriority;
+            siftUp(position);
+            siftDown(position);
+            return true;
+        }
+
+        const Entry & top() const
+        { return mEntries.front(); }
+
+        bool empty() const
+        { return mEntries.empty(); }
+
+        std::size_t size() const
+        { return mEntries.size(); }
+
+        //Entries in heap order, not sorted
+        auto begin() const
+        { return mEntries.begin(); }
+
+        auto end() const
+        { return mEntries.end(); }
+
+    private:
+        static constexpr std::size_t NOT_IN_HEAP = static_cast<std::size_t>(-1);
+
+        std::size_t find(const Handle<T> & aHandle) const
+        {
+            const std::size_t index = static_cast<std::size_t>(aHandle.mHandleIndex);
+            if (aHandle.mHandleIndex < 0 || index >= mPositions.size() || mPositions[index] == NOT_IN_HEAP)
+            {
+                return NOT_IN_HEAP;
+            }
+
+            //A reused slot index is another handle
+            const std::size_t position = mPositions[index];
+            return mEntries[position].handle == aHandle ? position : NOT_IN_HEAP;
+        }
+
+        void place(std::size_t aPosition, Entry && aEntry)
+        {
+            mPositions[static_cast<std::size_t>(aEntry.handle.mHandleIndex)] = aPosition;
+            mEntries[aPosition] = std::move(aEntry);
+        }
+
+        void siftUp(std::size_t aPosition)
+        {
+            Entry entry = std::move(mEntries[aPosition]);
+            while (aPosition > 0)
+            {
+                const std::size_t parent = (aPosition - 1) / 2;
+                if (mEntries[parent].priority >= entry.priority)
+                {
+                    break;
+                }
+
+                place(aPosition, std::move(mEntries[parent]));
+                aPosition = parent;
+            }
+            place(aPosition, std::move(entry));
+        }
+
+        void siftDown(std::size_t aPosition)
+        {
+            Entry entry = std::move(mEntries[aPosition]);
+            const std::size_t count = mEntries.size();
+            while (2 * aPosition + 1 < count)
+            {
+                std::size_t child = 2 * aPosition + 1;
+                if (child + 1 < count && mEntries[child + 1].priority > mEntries[child].priority)
+                {
+                    child++;
+                }
+
+                if (entry.priority >= mEntries[child].priority)
+                {
+                    break;
+                }
+
+                place(aPosition, std::move(mEntries[child]));
+                aPosition = child;
+            }
+            place(aPosition, std::move(entry));
+        }
+
+        std::vector<Entry> mEntries;
+        //Position in mEntries of each handle, indexed by handle index
+        std::vector<std::size_t> mPositions;
+};
+
+} // namespace sounds
+} // namespace ad
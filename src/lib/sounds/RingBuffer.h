@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace ad {
+namespace sounds {
+
+//Fixed capacity ring of samples addressed by absolute position
+//Positions keep growing, the ring holds the samples in [start, end)
+template<typename T>
+class RingBuffer
+{
+    public:
+        RingBuffer(std::size_t aCapacity = 0) :
+            mData(aCapacity)
+        {}
+
+        std::size_t getCapacity() const
+        { return mData.size(); }
+
+        std::size_t getStart() const
+        { return mStart; }
+
+        std::size_t getEnd() const
+        { return mEnd; }
+
+        std::size_t getSize() const
+        { return mEnd - mStart; }
+
+        std::size_t getFreeSpace() const
+        { return mData.size() - getSize(); }
+
+        void push(const T * aData, std::size_t aCount)
+        {
+            assert(aCount <= getFreeSpace());
+
+            while (aCount > 0)
+            {
+                const std::size_t index = mEnd % mData.size();
+                const std::size_t count = std::min(aCount, mData.size() - index);
+                std::copy(aData, aData + count, mData.begin() + index);
+                aData += count;
+                aCount -= count;
+                mEnd += count;
+            }
+        }
+
+        //Contiguous samples from aPosition, stops at the wrap point of the ring
+        //Empty if aPosition is not held by the ring
+        std::span<const T> getContiguous(std::size_t aPosition, std::size_t aMaxCount) const
+        {
+            if (aPosition < mStart || aPosition >= mEnd)
+            {
+                return {};
+            }
+
+            const std::size_t index = aPosition % mData.size();
+            const std::size_t count = std::min({aMaxCount, mEnd - aPosition, mData.size() - index});
+            return {mData.data() + index, count};
+        }
+
+        //Recycles every sample before aPosition
+        void consume(std::size_t aPosition)
+        {
+            mStart = std::clamp(aPosition, mStart, mEnd);
+        }
+
+        //Empties the ring, the next pushed sample is at aPosition
+        void reset(std::size_t aPosition = 0)
+        {
+            mStart = aPosition;
+            mEnd = aPosition;
+        }
+
+    private:
+        std::vector<T> mData;
+        std::size_t mStart = 0;
+        std::size_t mEnd = 0;
+};
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ad {
+namespace sounds {
+
+//Format of the decoded samples stored and uploaded to openAL
+//Int16 halves the memory and the upload bandwidth, float32 keeps the headroom
+enum SampleFormat
+{
+    SampleFormat_FLOAT32,
+    SampleFormat_INT16,
+};
+
+constexpr std::size_t getSampleSize(SampleFormat aFormat)
+{
+    return aFormat == SampleFormat_INT16 ? sizeof(std::int16_t) : sizeof(float);
+}
+
+inline std::int16_t toInt16Sample(float aSample)
+{
+    return static_cast<std::int16_t>(std::lrint(std::clamp(aSample, -1.f, 1.f) * 32767.f));
+}
+
+//Appends aCount float samples converted to aFormat
+inline void appendSamples(std::vector<std::byte> & aOutput, const float * aSamples, std::size_t aCount, SampleFormat aFormat)
+{
+    const std::size_t offset = aOutput.size();
+    aOutput.resize(offset + aCount * getSampleSize(aFormat));
+    std::byte * output = aOutput.data() + offset;
+
+    if (aCount == 0)
+    {
+        return;
+    }
+
+    if (aFormat == SampleFormat_FLOAT32)
+    {
+        std::memcpy(output, aSamples, aCount * sizeof(float));
+        return;
+    }
+
+    for (std::size_t i = 0; i < aCount; i++)
+    {
+        std::int16_t sample = toInt16Sample(aSamples[i]);
+        std::memcpy(output + i * sizeof(sample), &sample, sizeof(sample));
+    }
+}
+
+//Converts in place aCount float samples at the start of aData to aFormat
+//Returns the size in bytes of the converted samples
+inline std::size_t convertFloatSamples(std::byte * aData, std::size_t aCount, SampleFormat aFormat)
+{
+    if (aFormat == SampleFormat_INT16)
+    {
+        //Each converted sample is written at or before the float it comes from
+        for (std::size_t i = 0; i < aCount; i++)
+        {
+            float sample;
+            std::memcpy(&sample, aData + i * sizeof(float), sizeof(float));
+            std::int16_t converted = toInt16Sample(sample);
+            std::memcpy(aData + i * sizeof(converted), &converted, sizeof(converted));
+        }
+    }
+
+    return aCount * getSampleSize(aFormat);
+}
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ad {
+namespace sounds {
+
+//Refers to a value of a SlotMap, stays valid until the value is erased
+//A slot is reused with a new generation so handles to erased values resolve to nothing
+template<typename T>
+struct Handle
+{
+    Handle() :
+        mHandleIndex{-1},
+        mGeneration{-1},
+        mSlotMap{nullptr}
+    {}
+    Handle(int aHandleIndex, int aGeneration, void * aSlotMap) :
+        mHandleIndex{aHandleIndex},
+        mGeneration{aGeneration},
+        mSlotMap{aSlotMap}
+    {}
+
+    int mHandleIndex;
+    int mGeneration;
+    //SlotMap that made the handle, toObject() resolves through it
+    void * mSlotMap;
+
+    bool operator<(const Handle<T> & rHs) const
+    {
+        return mHandleIndex < rHs.mHandleIndex
+            || (mHandleIndex == rHs.mHandleIndex && mGeneration < rHs.mGeneration);
+    }
+
+    bool operator==(const Handle<T> & rHs) const
+    {
+        return mHandleIndex == rHs.mHandleIndex && mGeneration == rHs.mGeneration && mSlotMap == rHs.mSlotMap;
+    }
+
+    T * toObject() const;
+};
+
+//Values are stored contiguously with their handle, iterating yields [handle, value] pairs.
+//Resolving, inserting and erasing are O(1), erasing moves the last value in the hole
+//so it invalidates iterators and pointers to values.
+//Handles point to the map, it cannot be copied or moved
+template<typename T_object, typename T_value>
+class SlotMap
+{
+    public:
+        using Entry = std::pair<Handle<T_object>, T_value>;
+
+        SlotMap() = default;
+        SlotMap(const SlotMap &) = delete;
+        SlotMap & operator=(const SlotMap &) = delete;
+
+        Handle<T_object> insert(T_value aValue)
+        {
+            int slotIndex;
+
+            if (mFreeSlots.empty())
+            {
+                slotIndex = static_cast<int>(mSlots.size());
+                mSlots.push_back({});
+            }
+            else
+            {
+                slotIndex = mFreeSlots.back();
+                mFreeSlots.pop_back();
+            }
+
+            Slot & slot = mSlots[slotIndex];
+            slot.valueIndex = mValues.size();
+
+            Handle<T_object> handle{slotIndex, slot.generation, this};
+            mValues.push_back({handle, std::move(aValue)});
+            return handle;
+        }
+
+        //Returns nullptr if the value was erased
+        T_value * find(const Handle<T_object> & aHandle)
+        {
+            if (!contains(aHandle))
+            {
+                return nullptr;
+            }
+
+            return &mValues[mSlots[aHandle.mHandleIndex].valueIndex].second;
+        }
+
+        const T_value * find(const Handle<T_object> & aHandle) const
+        {
+            return const_cast<SlotMap *>(this)->find(aHandle);
+        }
+
+        bool contains(const Handle<T_object> & aHandle) const
+        {
+            return aHandle.mSlotMap == this
+                && aHandle.mHandleIndex >= 0
+                && static_cast<std::size_t>(aHandle.mHandleIndex) < mSlots.size()
+                && mSlots[aHandle.mHandleIndex].generation == aHandle.mGeneration;
+        }
+
+        bool erase(const Handle<T_object> & aHandle)
+        {
+            if (!contains(aHandle))
+            {
+                return false;
+            }
+
+            Slot & slot = mSlots[aHandle.mHandleIndex];
+
+            if (slot.valueIndex != mValues.size() - 1)
+            {
+                mValues[slot.valueIndex] = std::move(mValues.back());
+                mSlots[mValues[slot.valueIndex].first.mHandleIndex].valueIndex = slot.valueIndex;
+            }
+            mValues.pop_back();
+
+            slot.generation++;
+            mFreeSlots.push_back(aHandle.mHandleIndex);
+            return true;
+        }
+
+        //Handles of the erased values resolve to nothing
+        void clear()
+        {
+            for (const Entry & entry : mValues)
+            {
+                Slot & slot = mSlots[entry.first.mHandleIndex];
+                slot.generation++;
+                mFreeSlots.push_back(entry.first.mHandleIndex);
+            }
+            mValues.clear();
+        }
+
+        std::size_t size() const
+        { return mValues.size(); }
+
+        bool empty() const
+        { return mValues.empty(); }
+
+        typename std::vector<Entry>::iterator begin()
+        { return mValues.begin(); }
+
+        typename std::vector<Entry>::iterator end()
+        { return mValues.end(); }
+
+        typename std::vector<Entry>::const_iterator begin() const
+        { return mValues.begin(); }
+
+        typename std::vector<Entry>::const_iterator end() const
+        { return mValues.end(); }
+
+    private:
+        struct Slot
+        {
+            std::size_t valueIndex = 0;
+            int generation = 0;
+        };
+
+        std::vector<Entry> mValues;
+        std::vector<Slot> mSlots;
+        std::vector<int> mFreeSlots;
+};
+
+} // namespace sounds
+} // namespace ad
@@ -0,0 +1,209 @@
+#include "SoundBank.h"
+
+#define STB_VORBIS_NO_STDIO
+#define STB_VORBIS_NO_INTEGER_CONVERSION
+#include "stb_vorbis.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+
+namespace ad {
+namespace sounds {
+
+namespace {
+
+constexpr std::array<char, 4> SOUND_BANK_MAGIC{'A', 'D', 'S', 'B'};
+constexpr std::uint32_t SOUND_BANK_VERSION = 2;
+
+template<typename T>
+void writeInteger(std::vector<char> & aOutput, T aValue)
+{
+    for (std::size_t i = 0; i < sizeof(T); i++)
+    {
+        aOutput.push_back(static_cast<char>((aValue >> (8 * i)) & 0xff));
+    }
+}
+
+//Reads from aBank at aPosition and moves aPosition past the value
+template<typename T>
+bool readInteger(std::span<const char> aBank, std::size_t & aPosition, T & aValue)
+{
+    if (aBank.size() - aPosition < sizeof(T))
+    {
+        return false;
+    }
+
+    aValue = 0;
+    for (std::size_t i = 0; i < sizeof(T); i++)
+    {
+        aValue |= static_cast<T>(static_cast<unsigned char>(aBank[aPosition + i])) << (8 * i);
+    }
+    aPosition += sizeof(T);
+    return true;
+}
+
+} // anonymous namespace
+
+bool writeSoundBank(const filesystem::path & aBankPath, const std::vector<SoundManifestEntry> & aSounds)
+{
+    std::vector<SoundBankEntry> entries;
+    std::vector<std::vector<char>> sounds;
+
+    for (const SoundManifestEntry & sound : aSounds)
+    {
+        std::ifstream soundStream{sound.path.string(), std::ios::binary};
+        std::istreambuf_iterator<char> it{soundStream}, end;
+        std::vector<char> data{it, end};
+
+        int error = 0;
+        stb_vorbis * vorbisData = stb_vorbis_open_memory(
+                reinterpret_cast<const unsigned char *>(data.data()),
+                static_cast<int>(data.size()), &error, nullptr);
+
+        if (vorbisData == nullptr)
+        {
+            spdlog::get("sounds")->error("Cannot add {} to sound bank, stb vorbis error: {}", sound.path.string(), error);
+            return false;
+        }
+
+        stb_vorbis_info info = stb_vorbis_get_info(vorbisData);
+        stb_vorbis_close(vorbisData);
+
+        entries.push_back({
+            .name = sound.path.stem().string(),
+            .length = data.size(),
+            .channels = static_cast<std::uint16_t>(info.channels),
+            .sampleRate = info.sample_rate,
+            .streamed = sound.streamed,
+            .compressed = sound.compressed && !sound.streamed,
+            .sampleFormat = sound.sampleFormat,
+        });
+        sounds.push_back(std::move(data));
+    }
+
+    std::size_t indexSize = SOUND_BANK_MAGIC.size() + 2 * sizeof(std::uint32_t);
+    for (const SoundBankEntry & entry : entries)
+    {
+        indexSize += sizeof(std::uint16_t) + entry.name.size()
+            + 2 * sizeof(std::uint64_t) + sizeof(std::uint16_t) + sizeof(std::uint32_t) + 2 * sizeof(std::uint8_t);
+    }
+
+    std::uint64_t offset = indexSize;
+    for (SoundBankEntry & entry : entries)
+    {
+        entry.offset = offset;
+        offset += entry.length;
+    }
+
+    std::vector<char> index;
+    index.reserve(indexSize);
+    index.insert(index.end(), SOUND_BANK_MAGIC.begin(), SOUND_BANK_MAGIC.end());
+    writeInteger(index, SOUND_BANK_VERSION);
+    writeInteger(index, static_cast<std::uint32_t>(entries.size()));
+
+    for (const SoundBankEntry & entry : entries)
+    {
+        writeInteger(index, static_cast<std::uint16_t>(entry.name.size()));
+        index.insert(index.end(), entry.name.begin(), entry.name.end());
+        writeInteger(index, entry.offset);
+        writeInteger(index, entry.length);
+        writeInteger(index, entry.channels);
+        writeInteger(index, entry.sampleRate);
+        writeInteger(index, static_cast<std::uint8_t>(entry.streamed ? 1 : (entry.compressed ? 2 : 0)));
+        writeInteger(index, static_cast<std::uint8_t>(entry.sampleFormat ? *entry.sampleFormat + 1 : 0));
+    }
+
+    std::ofstream bankStream{aBankPath.string(), std::ios::binary};
+    bankStream.write(index.data(), index.size());
+    for (const std::vector<char> & sound : sounds)
+    {
+        bankStream.write(sound.data(), sound.size());
+    }
+
+    if (!bankStream)
+    {
+        spdlog::get("sounds")->error("Cannot write sound bank {}", aBankPath.string());
+        return false;
+    }
+
+    return true;
+}
+
+bool readSoundBankIndex(std::span<const char> aBank, std::vector<SoundBankEntry> & aEntries)
+{
+    if (aBank.size() < SOUND_BANK_MAGIC.size()
+            || !std::equal(SOUND_BANK_MAGIC.begin(), SOUND_BANK_MAGIC.end(), aBank.begin()))
+    {
+        spdlog::get("sounds")->error("Not a sound bank");
+        return false;
+    }
+
+    std::size_t position = SOUND_BANK_MAGIC.size();
+    std::uint32_t version = 0;
+    std::uint32_t entryCount = 0;
+
+    if (!readInteger(aBank, position, version) || version != SOUND_BANK_VERSION)
+    {
+        spdlog::get("sounds")->error("Unsupported sound bank version {}", version);
+        return false;
+    }
+
+    if (!readInteger(aBank, position, entryCount))
+    {
+        spdlog::get("sounds")->error("Truncated sound bank index");
+        return false;
+    }
+
+    for (std::uint32_t i = 0; i < entryCount; i++)
+    {
+        SoundBankEntry entry;
+        std::uint16_t nameLength = 0;
+        std::uint8_t storage = 0;
+        std::uint8_t sampleFormat = 0;
+
+        if (!readInteger(aBank, position, nameLength) || aBank.size() - position < nameLength)
+        {
+            spdlog::get("sounds")->error("Truncated sound bank index");
+            return false;
+        }
+
+        entry.name.assign(aBank.data() + position, nameLength);
+        position += nameLength;
+
+        if (!readInteger(aBank, position, entry.offset)
+                || !readInteger(aBank, position, entry.length)
+                || !readInteger(aBank, position, entry.channels)
+                || !readInteger(aBank, position, entry.sampleRate)
+                || !readInteger(aBank, position, storage)
+                || !readInteger(aBank, position, sampleFormat)
+                || storage > 2
+                || sampleFormat > SampleFormat_INT16 + 1)
+        {
+            spdlog::get("sounds")->error("Truncated sound bank index");
+            return false;
+        }
+        entry.streamed = storage == 1;
+        entry.compressed = storage == 2;
+        if (sampleFormat != 0)
+        {
+            entry.sampleFormat = static_cast<SampleFormat>(sampleFormat - 1);
+        }
+
+        if (entry.offset > aBank.size() || entry.length > aBank.size() - entry.offset)
+        {
+            spdlog::get("sounds")->error("Sound bank entry {} lies outside of the bank", entry.name);
+            return false;
+        }
+
+        aEntries.push_back(std::move(entry));
+    }
+
+    return true;
+}
+
+} // namespace sounds
+} // namespace ad
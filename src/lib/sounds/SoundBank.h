@@ -0,0 +1,53 @@
+#pragma once
+
+#include "SampleFormat.h"
+
+#include <platform/Filesystem.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ad {
+namespace sounds {
+
+//Sound to load, preload or pack in a sound bank
+struct SoundManifestEntry
+{
+    filesystem::path path;
+    bool streamed = false;
+    //Keeps the sound compressed in memory instead of decoding it, ignored for streamed sounds
+    bool compressed = false;
+    //Uses the format of the manager when not set
+    std::optional<SampleFormat> sampleFormat = std::nullopt;
+};
+
+//A sound bank packs ogg files after an index, all integers are little endian
+//  char[4] magic "ADSB", u32 version, u32 entry count
+//  per entry: u16 name length, name, u64 offset, u64 length, u16 channels, u32 sample rate,
+//  u8 storage (0 decoded, 1 streamed, 2 compressed),
+//  u8 sample format (0 for the format of the manager, SampleFormat + 1 otherwise)
+//Offsets are from the start of the bank
+struct SoundBankEntry
+{
+    std::string name;
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+    std::uint16_t channels = 0;
+    std::uint32_t sampleRate = 0;
+    bool streamed = false;
+    bool compressed = false;
+    std::optional<SampleFormat> sampleFormat;
+};
+
+//Names are the stem of each path
+bool writeSoundBank(const filesystem::path & aBankPath, const std::vector<SoundManifestEntry> & aSounds);
+
+//Returns false if the index is malformed or an entry lies outside of the bank
+bool readSoundBankIndex(std::span<const char> aBank, std::vector<SoundBankEntry> & aEntries);
+
+} // namespace sounds
+} // namespace ad
@@ -1,6 +1,12 @@
 #include "SoundManager.h"
 
+#include "MappedFile.h"
+#include "PcmCache.h"
+
 #include <AL/al.h>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
 #include <fstream>
 #include <functional>
@@ -9,6 +15,8 @@
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <spdlog/spdlog.h>
 #include <vector>
 #include <thread>
@@ -25,53 +33,83 @@ constexpr unsigned int SAMPLE_APPROXIMATION = 44100;
 constexpr unsigned int MAX_SAMPLES_FOR_NON_STREAM_DATA = MAXIMUM_DURATION_FOR_NON_STREAM * SAMPLE_APPROXIMATION;
 constexpr unsigned int MINIMUM_SAMPLE_BUFFERED_ON_CREATION = MINIMUM_DURATION_BUFFERED_ON_CREATION * SAMPLE_APPROXIMATION;
 constexpr unsigned int MINIMUM_SAMPLE_EXTRACTED = MINIMUM_DURATION_EXTRACTED * SAMPLE_APPROXIMATION;
+// Decoding is requested this many samples per channel before the playing sound runs out of decoded data
+// so the decoder pool has one extraction worth of time to deliver
+constexpr unsigned int DECODE_AHEAD_SAMPLE = 2 * MINIMUM_SAMPLE_EXTRACTED;
+// Capacity of the decoded ring of a streamed sound, per channel
+constexpr std::size_t STREAMED_RING_SAMPLE = 4 * MINIMUM_SAMPLE_EXTRACTED;
+// A vorbis frame decodes at most half of the biggest block size (8192) per channel
+constexpr std::size_t MAX_SAMPLES_PER_FRAME = 4096;
+// Samples per channel a decoding job drops at most while it skips to a position it cannot seek to
+constexpr std::size_t MAX_SKIPPED_SAMPLE_PER_CHUNK = 4 * MINIMUM_SAMPLE_EXTRACTED;
 constexpr unsigned int READ_CHUNK_SIZE = 16384.f * MINIMUM_DURATION_EXTRACTED * 2.f;
-constexpr std::array<ALenum, 3> SOUNDS_AL_FORMAT = {0, AL_FORMAT_MONO_FLOAT32, AL_FORMAT_MONO_FLOAT32};
-
+//Distance attenuation of the sources, openAL inverse distance clamped model
+constexpr float REFERENCE_DISTANCE = 1.f;
+constexpr float ROLLOFF_FACTOR = 1.f;
+//Indexed by sample format then by channel count
+constexpr std::array<std::array<ALenum, 3>, 2> SOUNDS_AL_FORMAT = {{
+    {0, AL_FORMAT_MONO_FLOAT32, AL_FORMAT_STEREO_FLOAT32},
+    {0, AL_FORMAT_MONO16, AL_FORMAT_STEREO16},
+}};
+
+//Handles of cues are only made by SoundManager::mCues and SoundManager::mPlayingCues
 template<>
 SoundCue * Handle<SoundCue>::toObject() const
 {
-    SoundCue * cue = mCues.at(*this).get();
-
-    if (cue != nullptr && cue->id == mUniqueId)
+    if (mSlotMap == nullptr)
     {
-        return cue;
+        return nullptr;
     }
 
-    return nullptr;
+    return static_cast<SlotMap<SoundCue, SoundCue> *>(mSlotMap)->find(*this);
 }
 
 template<>
 PlayingSoundCue * Handle<PlayingSoundCue>::toObject() const
 {
-    PlayingSoundCue * cue = mPlayingCues.at(*this).get();
-
-    if (cue != nullptr && cue->id == mUniqueId)
+    if (mSlotMap == nullptr)
     {
-        return cue;
+        return nullptr;
     }
 
-    return nullptr;
-}
-
-bool CmpHandlePriority(const Handle<PlayingSoundCue> & lhs, const Handle<PlayingSoundCue> & rhs)
-{
-    return lhs.toObject()->priority < rhs.toObject()->priority;
+    std::shared_ptr<PlayingSoundCue> * cue =
+        static_cast<SlotMap<PlayingSoundCue, std::shared_ptr<PlayingSoundCue>> *>(mSlotMap)->find(*this);
+    return cue != nullptr ? cue->get() : nullptr;
 }
 
 
-SoundManager::SoundManager(std::vector<SoundCategory> && aCategories):
+SoundManager::SoundManager(std::vector<SoundCategory> && aCategories, const SoundManagerOption & aOption):
     mOpenALDevice{alcOpenDevice(nullptr)},
     mOpenALContext{nullptr},
     mContextIsCurrent{AL_FALSE},
-    mSources{}
+    mLoadingOption{
+        .sampleFormat = aOption.sampleFormat,
+        .pcmCacheDirectory = aOption.pcmCacheDirectory,
+    },
+    mMemoryBudget{aOption.memoryBudget},
+    mKeepStaticSamples{aOption.keepStaticSamples},
+    mMaxVoices{aOption.maxVoices},
+    mInaudibleGain{aOption.inaudibleGain},
+    mVoiceLimitRadius{aOption.voiceLimitRadius},
+    mMaxVoicesPerRadius{aOption.maxVoicesPerRadius},
+    mLastUpdate{std::chrono::steady_clock::now()},
+    mThreadedFeeding{aOption.threadedFeeding},
+    mFeedingPeriod{aOption.feedingPeriod},
+    mDecoderPool{aOption.decodingThreads},
+    mLoadingPool{aOption.loadingThreads}
 {
     if (!mOpenALDevice) {
         /* fail */
         spdlog::get("sounds")->error("Cannot open OpenAL sound device");
     } else {
+        //OpenAL Soft treats the source counts as requests, they are queried back below
+        const ALCint attributes[] = {
+            ALC_MONO_SOURCES, static_cast<ALCint>(aOption.monoSources),
+            ALC_STEREO_SOURCES, static_cast<ALCint>(aOption.stereoSources),
+            0,
+        };
         if (!alcCall(alcCreateContext, mOpenALContext, mOpenALDevice, mOpenALDevice,
-                     nullptr)) {
+                     attributes)) {
             spdlog::get("sounds")->error("Cannot create OpenAL context");
         } else {
             if (!alcCall(alcMakeContextCurrent, mContextIsCurrent, mOpenALDevice,
@@ -81,13 +119,45 @@ SoundManager::SoundManager(std::vector<SoundCategory> && aCategories):
         }
     }
 
-    alCall(alGenSources, MAX_SOURCES, mSources.data());
+    std::size_t monoSources = 0;
+    std::size_t stereoSources = 0;
+    if (mContextIsCurrent)
+    {
+        ALCint deviceMonoSources = 0;
+        ALCint deviceStereoSources = 0;
+        alcCall(alcGetIntegerv, mOpenALDevice, mOpenALDevice, ALC_MONO_SOURCES, 1, &deviceMonoSources);
+        alcCall(alcGetIntegerv, mOpenALDevice, mOpenALDevice, ALC_STEREO_SOURCES, 1, &deviceStereoSources);
+        monoSources = std::min(aOption.monoSources, static_cast<std::size_t>(deviceMonoSources));
+        stereoSources = std::min(aOption.stereoSources, static_cast<std::size_t>(deviceStereoSources));
+        spdlog::get("sounds")->info(
+                "Using {} mono sources and {} stereo sources, the device grants {} and {}",
+                monoSources, stereoSources, deviceMonoSources, deviceStereoSources);
+    }
+
+    mMonoSourceCount = monoSources;
+    mSources.resize(monoSources + stereoSources);
+    mSourceOwners.resize(mSources.size());
+    if (!mSources.empty())
+    {
+        alCall(alGenSources, mSources.size(), mSources.data());
+    }
+
+    mBufferPool.reserve(aOption.bufferPoolSize != 0 ?
+            aOption.bufferPoolSize
+            : (monoSources + 2 * stereoSources) * 2 * BUFFER_PER_CHANNEL);
+    if (mVoiceLimitRadius > 0.f)
+    {
+        mVoiceGrid.reset(mVoiceLimitRadius);
+    }
 
-    int i = 0;
-    for (ALuint source : mSources)
+    for (std::size_t i = 0; i < mSources.size(); i++)
     {
+        const ALuint source = mSources[i];
         alCall(alSourcei, source, AL_SOURCE_RELATIVE, AL_TRUE);
-        mFreeSources.push_back(i++);
+        //Set explicitly so scoreVoices() attenuates like openAL
+        alCall(alSourcef, source, AL_REFERENCE_DISTANCE, REFERENCE_DISTANCE);
+        alCall(alSourcef, source, AL_ROLLOFF_FACTOR, ROLLOFF_FACTOR);
+        getFreeSources(i >= mMonoSourceCount).push_back(i);
     }
 
     alCall(alListener3f, AL_POSITION, 0.f, 0.f, 0.f);
@@ -104,11 +174,68 @@ SoundManager::SoundManager(std::vector<SoundCategory> && aCategories):
         mCuesByCategories.insert({category, {}});
         mCategoryOptions.insert({category, {}});
     }
+
+    if (mThreadedFeeding)
+    {
+        mFeeding = true;
+        mFeeder = std::thread{&SoundManager::feed, this};
+    }
 }
 
 SoundManager::~SoundManager()
 {
+    if (mFeeder.joinable())
+    {
+        mFeeding = false;
+        mFeeder.join();
+    }
+
     if (mContextIsCurrent) {
+        //Buffers can only be deleted once no source uses them
+        for (ALuint source : mSources)
+        {
+            alCall(alSourceStop, source);
+            alCall(alSourcei, source, AL_BUFFER, NULL);
+        }
+
+        //The feeder is joined, so the buffers of the cues are given back from this thread,
+        //including the cues whose STOP command it did not handle
+        FeederCommand command;
+        while (mFeederCommands.pop(command))
+        {
+            command.cue->releaseBuffers(mBufferPool);
+        }
+        for (const FeederCommand & overflowCommand : mOverflowFeederCommands)
+        {
+            overflowCommand.cue->releaseBuffers(mBufferPool);
+        }
+        mOverflowFeederCommands.clear();
+        for (const auto & [handle, cue] : mPlayingCues)
+        {
+            if (cue != nullptr)
+            {
+                cue->releaseBuffers(mBufferPool);
+            }
+        }
+
+        //Sound data deletes its static buffer, so it is released while the context exists
+        mVoices = {};
+        mPlayingCues.clear();
+        mLoadedSounds.clear();
+        {
+            std::scoped_lock lock{mLoadResultsMutex};
+            mLoadResults.clear();
+        }
+
+        spdlog::get("sounds")->info(
+                "Buffer pool held {} buffers, at most {} in use",
+                mBufferPool.getSize(), mBufferPool.getHighWaterMark());
+        mBufferPool.clear();
+        if (!mSources.empty())
+        {
+            alCall(alDeleteSources, mSources.size(), mSources.data());
+        }
+
         if (!alcCall(alcMakeContextCurrent, mContextIsCurrent, mOpenALDevice, nullptr)) {
             spdlog::get("sounds")->error("Well we're leaking audio memory now");
         }
@@ -124,57 +251,177 @@ SoundManager::~SoundManager()
     }
 }
 
-handy::StringId SoundManager::createData(const filesystem::path & aPath)
+namespace {
+
+//OpenAL only plays mono and stereo samples, 0 for other channel counts
+ALenum getAlFormat(SampleFormat aFormat, int aChannels, handy::StringId aSoundId)
+{
+    if (aChannels < 1 || aChannels > 2)
+    {
+        spdlog::get("sounds")->error(
+                "Cannot load {}, it has {} channels and only mono and stereo sounds are supported",
+                handy::revertStringId(aSoundId), aChannels);
+        return 0;
+    }
+
+    return SOUNDS_AL_FORMAT[aFormat][aChannels];
+}
+
+std::shared_ptr<OggSoundData> makeDecodedSoundData(
+        handy::StringId aSoundId,
+        std::size_t aCompressedSize,
+        stb_vorbis_info aVorbisInfo,
+        SampleFormat aFormat,
+        std::vector<std::byte> && aDecodedData)
 {
-    std::shared_ptr<std::ifstream> soundStream = std::make_shared<std::ifstream>(aPath.string(), std::ios::binary);
-    handy::StringId soundStringId = ad::handy::internalizeString(aPath.stem().string());
-    return createData(soundStream, soundStringId);
+    return std::make_shared<OggSoundData>(OggSoundData{
+        .soundId = aSoundId,
+        .usedData = static_cast<std::streamsize>(aCompressedSize),
+        .lengthRead = aCompressedSize,
+        .vorbisInfo = aVorbisInfo,
+        .lengthDecoded = aDecodedData.size() / getSampleSize(aFormat),
+        .fullyDecoded = true,
+        .dataFormat = getAlFormat(aFormat, aVorbisInfo.channels, aSoundId),
+        .sampleFormat = aFormat,
+        .streamedData = false,
+        .sampleRate = aVorbisInfo.sample_rate,
+        .decodedData = std::move(aDecodedData),
+    });
 }
 
-handy::StringId SoundManager::createData(
-        const std::shared_ptr<std::istream> & aInputStream, handy::StringId aSoundId)
+//Used when the length of the stream cannot be read, like in truncated or chained files
+//The float samples grow as frames are decoded, returns the samples read per channel
+int decodeUnknownLength(stb_vorbis * aVorbisData, int aChannels, std::vector<std::byte> & aDecodedData)
+{
+    const std::size_t chunkValues = static_cast<std::size_t>(MINIMUM_SAMPLE_EXTRACTED) * aChannels;
+    std::size_t valuesRead = 0;
+    int samplesRead = 0;
+
+    do
+    {
+        aDecodedData.resize((valuesRead + chunkValues) * sizeof(float));
+        samplesRead = stb_vorbis_get_samples_float_interleaved(
+                aVorbisData, aChannels, reinterpret_cast<float *>(aDecodedData.data()) + valuesRead,
+                static_cast<int>(chunkValues));
+        valuesRead += static_cast<std::size_t>(std::max(samplesRead, 0)) * aChannels;
+    } while (samplesRead > 0);
+
+    aDecodedData.resize(valuesRead * sizeof(float));
+    return static_cast<int>(valuesRead / aChannels);
+}
+
+//Loading only builds the sound data, so it can run on any thread
+//The samples are read from the pcm cache when its directory is set
+std::shared_ptr<OggSoundData> decodeData(
+        std::span<const char> aCompressedData,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
 {
-    std::istreambuf_iterator<char> it{*aInputStream}, end;
-    std::vector<std::uint8_t> data{it, end};
+    const SampleFormat format = aOption.sampleFormat;
+    std::uint64_t cacheKey = 0;
+    std::uint64_t sourceHash = 0;
+
+    if (!aOption.pcmCacheDirectory.empty())
+    {
+        //One entry per sound, it is replaced when the compressed data changes
+        cacheKey = hashContent(handy::revertStringId(aSoundId));
+        sourceHash = hashContent(aCompressedData);
+        CachedPcm pcm;
+        if (readPcmCache(aOption.pcmCacheDirectory, cacheKey, sourceHash, format, pcm))
+        {
+            stb_vorbis_info vorbisInfo{};
+            vorbisInfo.sample_rate = pcm.sampleRate;
+            vorbisInfo.channels = pcm.channels;
+            std::shared_ptr<OggSoundData> soundData =
+                makeDecodedSoundData(aSoundId, aCompressedData.size(), vorbisInfo, format, {});
+            //Uploaded from the mapping, the samples are never copied
+            soundData->cachedData = pcm.samples;
+            soundData->cachedDataOwner = std::move(pcm.samplesOwner);
+            soundData->lengthDecoded = pcm.samples.size() / getSampleSize(format);
+            return soundData;
+        }
+    }
+
     int error = 0;
 
     std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
     stb_vorbis * vorbisData = stb_vorbis_open_memory(
-            data.data(), static_cast<int>(data.size()), &error, nullptr);
+            reinterpret_cast<const unsigned char *>(aCompressedData.data()),
+            static_cast<int>(aCompressedData.size()), &error, nullptr);
+
+    if (vorbisData == nullptr)
+    {
+        spdlog::get("sounds")->error("Stb vorbis error while opening memory decoder: {}", error);
+        return nullptr;
+    }
+
     stb_vorbis_info vorbisInfo = stb_vorbis_get_info(vorbisData);
 
+    if (getAlFormat(format, vorbisInfo.channels, aSoundId) == 0)
+    {
+        stb_vorbis_close(vorbisData);
+        return nullptr;
+    }
+
     if (vorbisInfo.channels == 2)
     {
-        spdlog::get("sounds")->warn("Do not load stereo sound without streaming. Only mono source should be loaded using CreatePointSound and PointSound cannot be stereo.");
+        spdlog::get("sounds")->info("Sound {} is stereo, it plays on a stereo source and is not spatialized", handy::revertStringId(aSoundId));
     }
 
-    float decoded[MAX_SAMPLES_FOR_NON_STREAM_DATA];
-    int samplesRead = stb_vorbis_get_samples_float_interleaved(
-            vorbisData, vorbisInfo.channels, decoded, MAX_SAMPLES_FOR_NON_STREAM_DATA);
+    //The length is usually known up front, samples are then decoded straight in their final storage
+    const std::size_t sampleCount = stb_vorbis_stream_length_in_samples(vorbisData);
 
-    if (samplesRead == MAX_SAMPLES_FOR_NON_STREAM_DATA)
+    if (sampleCount > MAX_SAMPLES_FOR_NON_STREAM_DATA)
+    {
+        spdlog::get("sounds")->warn("Sound has {} samples. File is probably too long for non streaming", sampleCount);
+    }
+
+    //Decoded as float then converted in place
+    std::vector<std::byte> decodedData;
+    int samplesRead = 0;
+    if (sampleCount != 0)
     {
-        spdlog::get("sounds")->error("Read max samples for non stream data. File is probably too long for non streaming");
+        decodedData.resize(sampleCount * vorbisInfo.channels * sizeof(float));
+        samplesRead = stb_vorbis_get_samples_float_interleaved(
+                vorbisData, vorbisInfo.channels, reinterpret_cast<float *>(decodedData.data()),
+                static_cast<int>(sampleCount * vorbisInfo.channels));
+    }
+    else
+    {
+        spdlog::get("sounds")->warn("Sound {} length cannot be read, decoding it until its end", handy::revertStringId(aSoundId));
+        samplesRead = decodeUnknownLength(vorbisData, vorbisInfo.channels, decodedData);
     }
 
+    stb_vorbis_close(vorbisData);
+
     if (samplesRead == -1) {
         spdlog::get("sounds")->error("A read from the media returned an error");
+        samplesRead = 0;
     }
-    
-    std::shared_ptr<OggSoundData> resultSoundData = std::make_shared<OggSoundData>(OggSoundData{
-        .soundId = aSoundId,
-        .dataStream = aInputStream,
-        .usedData = static_cast<std::streamsize>(data.size()),
-        .fullyRead = true,
-        .vorbisData = {vorbisData, &stb_vorbis_close},
-        .vorbisInfo = vorbisInfo,
-        .lengthDecoded = static_cast<std::size_t>(samplesRead) * vorbisInfo.channels,
-        .fullyDecoded = true,
-        .dataFormat = SOUNDS_AL_FORMAT[vorbisInfo.channels],
-        .streamedData = false,
-        .sampleRate = vorbisInfo.sample_rate,
-        .decodedData = {decoded, decoded + samplesRead * vorbisInfo.channels},
-    });
+
+    //The length is only an estimation for damaged files
+    decodedData.resize(convertFloatSamples(
+                decodedData.data(), static_cast<std::size_t>(samplesRead) * vorbisInfo.channels, format));
+    if (sampleCount == 0)
+    {
+        //Growing left spare capacity
+        decodedData.shrink_to_fit();
+    }
+
+    if (!aOption.pcmCacheDirectory.empty())
+    {
+        writePcmCache(
+                aOption.pcmCacheDirectory,
+                cacheKey,
+                sourceHash,
+                vorbisInfo.channels,
+                vorbisInfo.sample_rate,
+                format,
+                decodedData);
+    }
+
+    std::shared_ptr<OggSoundData> resultSoundData = makeDecodedSoundData(
+            aSoundId, aCompressedData.size(), vorbisInfo, format, std::move(decodedData));
 
     std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
 
@@ -182,34 +429,86 @@ handy::StringId SoundManager::createData(
 
     spdlog::get("sounds")->info("Samples: {}, total used bytes: {}, Elapsed time: {}, length decoded: {}", samplesRead, resultSoundData->usedData, diff.count(), resultSoundData->lengthDecoded * resultSoundData->vorbisInfo.channels);
 
-    mLoadedSounds.insert({resultSoundData->soundId, resultSoundData});
+    return resultSoundData;
+}
+
+std::shared_ptr<OggSoundData> loadData(
+        std::istream & aInputStream,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
+{
+    std::istreambuf_iterator<char> it{aInputStream}, end;
+    std::vector<char> data{it, end};
+    return decodeData(data, aSoundId, aOption);
+}
+
+//The file is decoded straight from its mapping
+std::shared_ptr<OggSoundData> loadData(
+        const filesystem::path & aPath,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
+{
+    MappedFile file{aPath};
+    if (file.isOpen())
+    {
+        return decodeData(file.getBytes(), aSoundId, aOption);
+    }
 
-    return resultSoundData->soundId;
+    std::ifstream soundStream{aPath.string(), std::ios::binary};
+    return loadData(soundStream, aSoundId, aOption);
 }
 
-//Streamed version of ogg data
-handy::StringId SoundManager::createStreamedOggData(const filesystem::path & aPath)
+std::function<std::unique_ptr<std::istream>()> openFile(const filesystem::path & aPath)
 {
-    const std::shared_ptr<std::ifstream> soundStream = std::make_shared<std::ifstream>(aPath.string(), std::ios::binary);
-    if (soundStream->fail())
+    if (!filesystem::exists(aPath))
     {
         spdlog::get("sounds")->error("File {} does not exists", aPath.string());
     }
-    handy::StringId soundStringId = ad::handy::internalizeString(aPath.stem().string());
-    return createStreamedOggData(soundStream, soundStringId);
+
+    return [aPath]() -> std::unique_ptr<std::istream>
+    {
+        return std::make_unique<std::ifstream>(aPath.string(), std::ios::binary);
+    };
 }
 
-handy::StringId SoundManager::createStreamedOggData(
-        const std::shared_ptr<std::istream> & aInputStream, handy::StringId aSoundId)
+//The start of the sound is decoded while loading, so a playback never waits on the decoder pool
+//and its own stream has time to catch up
+std::shared_ptr<OggSoundData> primeStreamedOggData(std::shared_ptr<OggSoundData> aSoundData)
+{
+    std::shared_ptr<OggStream> firstStream = std::make_shared<OggStream>(*aSoundData);
+    DecodedChunk firstChunk = decodeStreamChunk(
+            *aSoundData,
+            firstStream,
+            true,
+            MINIMUM_SAMPLE_BUFFERED_ON_CREATION,
+            (MINIMUM_SAMPLE_BUFFERED_ON_CREATION + MAX_SAMPLES_PER_FRAME) * aSoundData->vorbisInfo.channels,
+            0);
+    aSoundData->decodedData = std::move(firstChunk.decodedData);
+    aSoundData->lengthDecoded = aSoundData->decodedData.size() / getSampleSize(aSoundData->sampleFormat);
+    aSoundData->fullyDecoded = firstChunk.fullyDecoded;
+    aSoundData->lengthRead = firstStream->lengthRead;
+
+    return aSoundData;
+}
+
+//Streamed version of ogg data
+//Each playback opens its own stream with aOpenStream
+std::shared_ptr<OggSoundData> loadStreamedOggData(
+        std::function<std::unique_ptr<std::istream>()> aOpenStream,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
 {
     int used = 0;
     int error = 0;
 
+    std::unique_ptr<std::istream> inputStream = aOpenStream();
+
     std::vector<char> headerData(HEADER_BLOCK_SIZE);
 
-    aInputStream->read(headerData.data(), HEADER_BLOCK_SIZE);
+    inputStream->read(headerData.data(), HEADER_BLOCK_SIZE);
 
-    std::streamsize lengthRead = aInputStream->gcount();
+    std::streamsize lengthRead = inputStream->gcount();
+    headerData.resize(lengthRead);
     spdlog::get("sounds")->info("length read for header bytes {}", lengthRead);
 
     stb_vorbis * vorbisData = nullptr;
@@ -223,17 +522,22 @@ handy::StringId SoundManager::createStreamedOggData(
         if (vorbisData == nullptr) {
             if (error == VORBIS_need_more_data) [[likely]] {
                 std::vector<char> moreHeaderData(HEADER_BLOCK_SIZE);
-                aInputStream->read(moreHeaderData.data(), HEADER_BLOCK_SIZE);
+                inputStream->read(moreHeaderData.data(), HEADER_BLOCK_SIZE);
+                if (inputStream->gcount() == 0)
+                {
+                    spdlog::get("sounds")->error("Stream ended before the end of the vorbis headers");
+                    return nullptr;
+                }
                 headerData.insert(headerData.end(), moreHeaderData.begin(),
-                                  moreHeaderData.end());
-                lengthRead += aInputStream->gcount();
+                                  moreHeaderData.begin() + inputStream->gcount());
+                lengthRead += inputStream->gcount();
                 spdlog::get("sounds")->info(
                     "Unusually large headers required proceeding with a bigger chunk");
             } else {
                 spdlog::get("sounds")->error(
                     "Stb vorbis error while opening pushdata decoder: {}", error);
 
-                return handy::StringId::Null();
+                return nullptr;
             }
         }
     }
@@ -241,201 +545,1962 @@ handy::StringId SoundManager::createStreamedOggData(
     spdlog::get("sounds")->info("Used bytes for header {}", used);
 
     stb_vorbis_info info = stb_vorbis_get_info(vorbisData);
+    stb_vorbis_close(vorbisData);
 
     spdlog::get("sounds")->info("Number of channels {}", info.channels);
 
+    const ALenum dataFormat = getAlFormat(aOption.sampleFormat, info.channels, aSoundId);
+    if (dataFormat == 0)
+    {
+        return nullptr;
+    }
+
     std::shared_ptr<OggSoundData> resultSoundData = std::make_shared<OggSoundData>(OggSoundData{
         .soundId = aSoundId,
-        .dataStream = aInputStream,
+        .openStream = std::move(aOpenStream),
+        .headerData = std::move(headerData),
         .usedData = used,
-        .undecodedReadData = {headerData.begin(), headerData.end()},
-        .lengthRead = static_cast<std::size_t>(lengthRead),
-        .fullyRead = false,
-        .vorbisData = {vorbisData, &stb_vorbis_close},
         .vorbisInfo = info,
         .fullyDecoded = false,
-        .dataFormat = SOUNDS_AL_FORMAT[info.channels],
+        .dataFormat = dataFormat,
+        .sampleFormat = aOption.sampleFormat,
         .streamedData = true,
         .sampleRate = info.sample_rate,
     });
 
-    mLoadedSounds.insert({resultSoundData->soundId, resultSoundData});
-
-    return resultSoundData->soundId;
+    return primeStreamedOggData(std::move(resultSoundData));
 }
 
-void decodeSoundData(
-        const std::shared_ptr<OggSoundData> & aData,
-        unsigned int aMinSamples = MINIMUM_SAMPLE_EXTRACTED)
+//Streamed sound held in memory, each playback decodes it in place
+std::shared_ptr<OggSoundData> loadStreamedOggData(
+        std::shared_ptr<const void> aCompressedDataOwner,
+        std::span<const char> aCompressedData,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
 {
-    stb_vorbis * vorbisData = aData->vorbisData;
-
-    std::istream & inputStream = *aData->dataStream;
-    std::vector<char> & soundData = aData->undecodedReadData;
+    int used = 0;
+    int error = 0;
 
-    int channels = 0;
+    stb_vorbis * vorbisData = stb_vorbis_open_pushdata(
+            reinterpret_cast<const unsigned char *>(aCompressedData.data()),
+            static_cast<int>(aCompressedData.size()), &used, &error, nullptr);
 
-    int used = static_cast<int>(aData->usedData);
-    float ** output;
-    int samplesRead = 0;
+    if (vorbisData == nullptr)
+    {
+        spdlog::get("sounds")->error("Stb vorbis error while opening pushdata decoder: {}", error);
+        return nullptr;
+    }
 
-    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-    while (samplesRead < static_cast<int>(aMinSamples)) {
-        int currentUsed = -1;
+    stb_vorbis_info info = stb_vorbis_get_info(vorbisData);
+    stb_vorbis_close(vorbisData);
 
-        while (currentUsed != 0)
-        {
-            int passSampleRead = 0;
+    const ALenum dataFormat = getAlFormat(aOption.sampleFormat, info.channels, aSoundId);
+    if (dataFormat == 0)
+    {
+        return nullptr;
+    }
 
-            currentUsed = stb_vorbis_decode_frame_pushdata(
-                vorbisData, reinterpret_cast<unsigned char *>(soundData.data() + used),
-                static_cast<int>(soundData.size()) - used,
-                &channels, &output, &passSampleRead);
+    std::shared_ptr<OggSoundData> resultSoundData = std::make_shared<OggSoundData>(OggSoundData{
+        .soundId = aSoundId,
+        .compressedData = aCompressedData,
+        .compressedDataOwner = std::move(aCompressedDataOwner),
+        .usedData = used,
+        .vorbisInfo = info,
+        .fullyDecoded = false,
+        .dataFormat = dataFormat,
+        .sampleFormat = aOption.sampleFormat,
+        .streamedData = true,
+        .sampleRate = info.sample_rate,
+    });
 
-            used += currentUsed;
+    return primeStreamedOggData(std::move(resultSoundData));
+}
 
-            samplesRead += passSampleRead;
+//The file is mapped and shared by every playback, it is read through a stream
+//only if it cannot be mapped
+std::shared_ptr<OggSoundData> loadStreamedOggData(
+        const filesystem::path & aPath,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
+{
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(aPath);
+    if (file->isOpen())
+    {
+        std::span<const char> bytes = file->getBytes();
+        return loadStreamedOggData(std::move(file), bytes, aSoundId, aOption);
+    }
 
-            if (passSampleRead > 0)
-            {
-                if (channels == 2)
-                {
-                    std::vector<float> interleavedData = interleave(
-                            output[0], output[1], passSampleRead);
-                    aData->decodedData.insert(
-                            aData->decodedData.end(),
-                            interleavedData.begin(), interleavedData.end());
-                }
-                else
-                {
-                    aData->decodedData.insert(
-                            aData->decodedData.end(),
-                            &output[0][0], &output[0][passSampleRead]);
-                }
-            }
-        }
+    return loadStreamedOggData(openFile(aPath), aSoundId, aOption);
+}
 
-        if (!aData->fullyRead)
-        {
-            std::array<char, READ_CHUNK_SIZE> moreHeaderData;
-            inputStream.read(moreHeaderData.data(), READ_CHUNK_SIZE);
-            soundData.insert(
-                    soundData.end(), moreHeaderData.begin(), moreHeaderData.end());
-            std::streamsize lengthRead = inputStream.gcount();
-            spdlog::get("sounds")->info("Reading new chunk from {} to {}", aData->lengthRead, aData->lengthRead + lengthRead);
-            aData->lengthRead += lengthRead;
+//The compressed bytes are kept in memory and shared by every playback
+std::shared_ptr<OggSoundData> loadStreamedOggData(
+        std::istream & aInputStream,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
+{
+    std::istreambuf_iterator<char> it{aInputStream}, end;
+    std::shared_ptr<const std::vector<char>> compressedData = std::make_shared<const std::vector<char>>(it, end);
+    std::span<const char> bytes{*compressedData};
+    return loadStreamedOggData(std::move(compressedData), bytes, aSoundId, aOption);
+}
 
-            if (lengthRead < READ_CHUNK_SIZE)
-            {
-                aData->fullyRead = true;
-            }
-        }
+//Nothing is decoded while loading, each playback decodes the sound in a ring sized to it
+std::shared_ptr<OggSoundData> loadCompressedData(
+        std::shared_ptr<const void> aCompressedDataOwner,
+        std::span<const char> aCompressedData,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
+{
+    int error = 0;
+    stb_vorbis * vorbisData = stb_vorbis_open_memory(
+            reinterpret_cast<const unsigned char *>(aCompressedData.data()),
+            static_cast<int>(aCompressedData.size()), &error, nullptr);
 
-        if (aData->fullyRead && static_cast<std::size_t>(used) == aData->lengthRead)
-        {
-            spdlog::get("sounds")->info("Fully decoded");
-            aData->fullyDecoded = true;
-            break;
-        }
+    if (vorbisData == nullptr)
+    {
+        spdlog::get("sounds")->error("Stb vorbis error while opening memory decoder: {}", error);
+        return nullptr;
     }
 
-    aData->lengthDecoded += static_cast<std::size_t>(samplesRead) * channels;
-    aData->usedData = used;
+    stb_vorbis_info info = stb_vorbis_get_info(vorbisData);
+    const std::size_t sampleCount = stb_vorbis_stream_length_in_samples(vorbisData);
+    stb_vorbis_close(vorbisData);
 
-    std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+    const ALenum dataFormat = getAlFormat(aOption.sampleFormat, info.channels, aSoundId);
+    if (dataFormat == 0)
+    {
+        return nullptr;
+    }
 
-    std::chrono::duration<double> diff = after - now;
+    //Playbacks decode it until its end, only its duration is unknown
+    if (sampleCount == 0)
+    {
+        spdlog::get("sounds")->warn("Sound {} length cannot be read, its virtual voices never end", handy::revertStringId(aSoundId));
+    }
 
-    spdlog::get("sounds")->info("Samples: {}, total used bytes: {}, Elapsed time: {}, length decoded: {}", samplesRead, aData->usedData, diff.count(), aData->lengthDecoded * aData->vorbisInfo.channels);
-}
+    if (sampleCount > MAX_SAMPLES_FOR_NON_STREAM_DATA)
+    {
+        spdlog::get("sounds")->warn("Sound has {} samples. File is probably too long to be kept compressed, stream it", sampleCount);
+    }
 
+    return std::make_shared<OggSoundData>(OggSoundData{
+        .soundId = aSoundId,
+        .compressedData = aCompressedData,
+        .compressedDataOwner = std::move(aCompressedDataOwner),
+        .lengthRead = aCompressedData.size(),
+        .vorbisInfo = info,
+        .lengthInSamples = sampleCount,
+        .fullyDecoded = false,
+        .dataFormat = dataFormat,
+        .sampleFormat = aOption.sampleFormat,
+        .streamedData = true,
+        .compressedResident = true,
+        .sampleRate = info.sample_rate,
+    });
+}
 
-ALint SoundManager::getSourceState(ALuint aSource)
+//The compressed bytes are copied to the heap so they stay resident
+std::shared_ptr<OggSoundData> loadCompressedData(
+        std::istream & aInputStream,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
 {
-    ALint sourceState;
-    alCall(alGetSourcei, aSource, AL_SOURCE_STATE, &sourceState);
-    return sourceState;
+    std::istreambuf_iterator<char> it{aInputStream}, end;
+    std::shared_ptr<const std::vector<char>> compressedData = std::make_shared<const std::vector<char>>(it, end);
+    std::span<const char> bytes{*compressedData};
+    return loadCompressedData(std::move(compressedData), bytes, aSoundId, aOption);
 }
 
-void SoundManager::update()
+std::shared_ptr<OggSoundData> loadCompressedData(
+        const filesystem::path & aPath,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
 {
-    spdlog::get("sounds")->trace("# free sources: {}", mFreeSources.size());
-    int realPlayingSound = 0;
-    for (auto & [handle, sound] : mPlayingCues)
+    //The mapping is only read once, the resident bytes are copied from it in one go
+    MappedFile file{aPath};
+    if (file.isOpen())
     {
-        if (sound.get() != nullptr)
-        {
-            realPlayingSound++;
-        }
+        const std::span<const char> mappedBytes = file.getBytes();
+        std::shared_ptr<const std::vector<char>> compressedData =
+            std::make_shared<const std::vector<char>>(mappedBytes.begin(), mappedBytes.end());
+        std::span<const char> bytes{*compressedData};
+        return loadCompressedData(std::move(compressedData), bytes, aSoundId, aOption);
     }
 
-    spdlog::get("sounds")->trace("# playing sound: {}", realPlayingSound);
-    spdlog::get("sounds")->trace("# number of prioriry queue: {}", mCuesByCategories.size());
+    std::ifstream soundStream{aPath.string(), std::ios::binary};
+    if (!soundStream)
+    {
+        spdlog::get("sounds")->error("File {} does not exists", aPath.string());
+        return nullptr;
+    }
 
-    for (auto & [cat, queue] : mCuesByCategories)
+    return loadCompressedData(soundStream, aSoundId, aOption);
+}
+
+//Loads a sound of a manifest with the storage it asks for
+SoundLoader makeManifestLoader(
+        const SoundManifestEntry & aEntry,
+        handy::StringId aSoundId,
+        const LoadingOption & aOption)
+{
+    filesystem::path path = aEntry.path;
+
+    if (aEntry.streamed)
     {
-        spdlog::get("sounds")->trace("# number sound in priority queue {}: {}", cat, queue.size());
+        return [path, aSoundId, aOption]() { return loadStreamedOggData(path, aSoundId, aOption); };
     }
 
-    for (const auto & [handle, currentCue] : mPlayingCues)
+    if (aEntry.compressed)
     {
-        if (currentCue != nullptr && currentCue->state != PlayingSoundCueState_NOT_PLAYING)
-        {
-            updateCue(*currentCue, handle);
-        }
+        return [path, aSoundId, aOption]() { return loadCompressedData(path, aSoundId, aOption); };
     }
+
+    return [path, aSoundId, aOption]() { return loadData(path, aSoundId, aOption); };
+}
+
+} // anonymous namespace
+
+handy::StringId SoundManager::createData(const filesystem::path & aPath)
+{
+    handy::StringId soundId = ad::handy::internalizeString(aPath.stem().string());
+    return loadSound(
+            soundId,
+            [aPath, soundId, option = mLoadingOption]()
+            {
+                return loadData(aPath, soundId, option);
+            },
+            true);
+}
+
+handy::StringId SoundManager::createData(
+        const std::shared_ptr<std::istream> & aInputStream, handy::StringId aSoundId)
+{
+    return loadSound(
+            aSoundId,
+            [aInputStream, aSoundId, option = mLoadingOption]()
+            {
+                return loadData(*aInputStream, aSoundId, option);
+            },
+            false);
+}
+
+handy::StringId SoundManager::createStreamedOggData(const filesystem::path & aPath)
+{
+    handy::StringId soundId = ad::handy::internalizeString(aPath.stem().string());
+    return loadSound(
+            soundId,
+            [aPath, soundId, option = mLoadingOption]()
+            {
+                return loadStreamedOggData(aPath, soundId, option);
+            },
+            true);
+}
+
+handy::StringId SoundManager::createStreamedOggData(
+        const std::shared_ptr<std::istream> & aInputStream, handy::StringId aSoundId)
+{
+    return loadSound(
+            aSoundId,
+            [aInputStream, aSoundId, option = mLoadingOption]()
+            {
+                return loadStreamedOggData(*aInputStream, aSoundId, option);
+            },
+            false);
+}
+
+handy::StringId SoundManager::createCompressedData(const filesystem::path & aPath)
+{
+    handy::StringId soundId = ad::handy::internalizeString(aPath.stem().string());
+    return loadSound(
+            soundId,
+            [aPath, soundId, option = mLoadingOption]()
+            {
+                return loadCompressedData(aPath, soundId, option);
+            },
+            true);
+}
+
+handy::StringId SoundManager::createCompressedData(
+        const std::shared_ptr<std::istream> & aInputStream, handy::StringId aSoundId)
+{
+    return loadSound(
+            aSoundId,
+            [aInputStream, aSoundId, option = mLoadingOption]()
+            {
+                return loadCompressedData(*aInputStream, aSoundId, option);
+            },
+            false);
+}
+
+handy::StringId SoundManager::createDataAsync(const filesystem::path & aPath, LoadingCallback aCallback)
+{
+    handy::StringId soundId = ad::handy::internalizeString(aPath.stem().string());
+    loadAsync(
+            soundId,
+            [aPath, soundId, option = mLoadingOption]()
+            {
+                return loadData(aPath, soundId, option);
+            },
+            std::move(aCallback),
+            true);
+    return soundId;
+}
+
+handy::StringId SoundManager::createDataAsync(
+        const std::shared_ptr<std::istream> & aInputStream,
+        handy::StringId aSoundId,
+        LoadingCallback aCallback)
+{
+    loadAsync(
+            aSoundId,
+            [aInputStream, aSoundId, option = mLoadingOption]()
+            {
+                return loadData(*aInputStream, aSoundId, option);
+            },
+            std::move(aCallback),
+            false);
+    return aSoundId;
+}
+
+handy::StringId SoundManager::createStreamedOggDataAsync(const filesystem::path & aPath, LoadingCallback aCallback)
+{
+    handy::StringId soundId = ad::handy::internalizeString(aPath.stem().string());
+    loadAsync(
+            soundId,
+            [aPath, soundId, option = mLoadingOption]()
+            {
+                return loadStreamedOggData(aPath, soundId, option);
+            },
+            std::move(aCallback),
+            true);
+    return soundId;
+}
+
+handy::StringId SoundManager::createStreamedOggDataAsync(
+        const std::shared_ptr<std::istream> & aInputStream,
+        handy::StringId aSoundId,
+        LoadingCallback aCallback)
+{
+    loadAsync(
+            aSoundId,
+            [aInputStream, aSoundId, option = mLoadingOption]()
+            {
+                return loadStreamedOggData(*aInputStream, aSoundId, option);
+            },
+            std::move(aCallback),
+            false);
+    return aSoundId;
+}
+
+handy::StringId SoundManager::createCompressedDataAsync(const filesystem::path & aPath, LoadingCallback aCallback)
+{
+    handy::StringId soundId = ad::handy::internalizeString(aPath.stem().string());
+    loadAsync(
+            soundId,
+            [aPath, soundId, option = mLoadingOption]()
+            {
+                return loadCompressedData(aPath, soundId, option);
+            },
+            std::move(aCallback),
+            true);
+    return soundId;
+}
+
+handy::StringId SoundManager::createCompressedDataAsync(
+        const std::shared_ptr<std::istream> & aInputStream,
+        handy::StringId aSoundId,
+        LoadingCallback aCallback)
+{
+    loadAsync(
+            aSoundId,
+            [aInputStream, aSoundId, option = mLoadingOption]()
+            {
+                return loadCompressedData(*aInputStream, aSoundId, option);
+            },
+            std::move(aCallback),
+            false);
+    return aSoundId;
+}
+
+LoadingState SoundManager::getLoadingState(handy::StringId aSoundId) const
+{
+    if (mLoadedSounds.contains(aSoundId))
+    {
+        return LoadingState_LOADED;
+    }
+
+    if (mPendingLoads.contains(aSoundId))
+    {
+        return LoadingState_LOADING;
+    }
+
+    return LoadingState_NOT_LOADED;
+}
+
+PreloadStats SoundManager::preloadSounds(const std::vector<SoundManifestEntry> & aManifest)
+{
+    struct PreloadedSound
+    {
+        std::shared_ptr<OggSoundData> soundData;
+        std::chrono::duration<double> loadingTime{0};
+    };
+
+    std::vector<PreloadedSound> preloadedSounds(aManifest.size());
+    std::atomic<std::size_t> memory = 0;
+    std::atomic<std::size_t> peakMemory = 0;
+    std::size_t remaining = aManifest.size();
+    std::mutex remainingMutex;
+    std::condition_variable remainingCondition;
+
+    auto addMemory = [&memory, &peakMemory](std::size_t aSize)
+    {
+        std::size_t current = memory.fetch_add(aSize) + aSize;
+        std::size_t peak = peakMemory.load();
+        while (current > peak && !peakMemory.compare_exchange_weak(peak, current))
+        {}
+    };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<handy::StringId> soundIds;
+
+    for (std::size_t i = 0; i < aManifest.size(); i++)
+    {
+        handy::StringId soundId = ad::handy::internalizeString(aManifest[i].path.stem().string());
+        SoundLoader load = makeManifestLoader(aManifest[i], soundId, getLoadingOption(aManifest[i].sampleFormat));
+        mSoundLoaders.insert_or_assign(soundId, load);
+        soundIds.push_back(soundId);
+
+        mLoadingPool.push([&, i, load]()
+        {
+            const SoundManifestEntry & entry = aManifest[i];
+            std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+
+            //The compressed data is held while it is decoded
+            std::error_code error;
+            std::uintmax_t fileSize = filesystem::file_size(entry.path, error);
+            std::size_t compressedSize = error ? 0 : static_cast<std::size_t>(fileSize);
+            addMemory(compressedSize);
+
+            std::shared_ptr<OggSoundData> soundData = load();
+
+            addMemory(soundData != nullptr ? getResidentSize(*soundData) : 0);
+            memory -= compressedSize;
+
+            preloadedSounds[i] = {
+                .soundData = std::move(soundData),
+                .loadingTime = std::chrono::steady_clock::now() - loadStart,
+            };
+
+            //Notified under the lock, the waiting thread destroys the condition once woken up
+            std::scoped_lock lock{remainingMutex};
+            remaining--;
+            remainingCondition.notify_one();
+        });
+    }
+
+    {
+        std::unique_lock lock{remainingMutex};
+        remainingCondition.wait(lock, [&remaining]{ return remaining == 0; });
+    }
+
+    PreloadStats stats;
+
+    for (std::size_t i = 0; i < preloadedSounds.size(); i++)
+    {
+        PreloadedSound & preloaded = preloadedSounds[i];
+
+        if (preloaded.soundData != nullptr)
+        {
+            stats.bytesRead += preloaded.soundData->lengthRead;
+        }
+        else
+        {
+            stats.failedCount++;
+            mSoundLoaders.erase(soundIds[i]);
+        }
+
+        stats.soundIds.push_back(addLoadedSound(preloaded.soundData));
+        if (stats.soundIds.back() != handy::StringId::Null())
+        {
+            mSoundReferences[soundIds[i]]++;
+        }
+        stats.decodeTime += preloaded.loadingTime;
+    }
+
+    stats.elapsedTime = std::chrono::steady_clock::now() - start;
+    stats.peakMemory = peakMemory;
+
+    spdlog::get("sounds")->info(
+            "Preloaded {} sounds ({} failed), bytes read: {}, decode time: {}, elapsed time: {}, peak memory: {}",
+            aManifest.size(), stats.failedCount, stats.bytesRead,
+            stats.decodeTime.count(), stats.elapsedTime.count(), stats.peakMemory);
+
+    return stats;
+}
+
+std::vector<handy::StringId> SoundManager::loadSoundBank(const filesystem::path & aPath)
+{
+    std::shared_ptr<MappedFile> bank = std::make_shared<MappedFile>(aPath);
+    std::vector<SoundBankEntry> entries;
+
+    if (!bank->isOpen() || !readSoundBankIndex(bank->getBytes(), entries))
+    {
+        spdlog::get("sounds")->error("Cannot load sound bank {}", aPath.string());
+        return {};
+    }
+
+    std::vector<handy::StringId> soundIds;
+
+    for (SoundBankEntry & entry : entries)
+    {
+        handy::StringId soundId = ad::handy::internalizeString(entry.name);
+        std::span<const char> compressedData = bank->getBytes().subspan(entry.offset, entry.length);
+        LoadingOption option = getLoadingOption(entry.sampleFormat);
+
+        //The loader keeps the bank mapped
+        mSoundLoaders.insert_or_assign(soundId, [bank, compressedData, entry = std::move(entry), soundId, option]()
+        {
+            std::shared_ptr<OggSoundData> soundData;
+            if (entry.streamed)
+            {
+                soundData = loadStreamedOggData(bank, compressedData, soundId, option);
+            }
+            else if (entry.compressed)
+            {
+                //Decoded from the mapping of the bank by each playback
+                soundData = loadCompressedData(bank, compressedData, soundId, option);
+            }
+            else
+            {
+                soundData = decodeData(compressedData, soundId, option);
+            }
+
+            if (soundData != nullptr
+                    && (soundData->vorbisInfo.channels != entry.channels
+                        || soundData->sampleRate != entry.sampleRate))
+            {
+                spdlog::get("sounds")->warn("Sound bank index does not match the sound {}", entry.name);
+            }
+
+            return soundData;
+        });
+        mSoundReferences[soundId]++;
+        soundIds.push_back(soundId);
+    }
+
+    spdlog::get("sounds")->info("Registered {} sounds from bank {}", soundIds.size(), aPath.string());
+
+    return soundIds;
+}
+
+//Loads sounds on first use on the calling thread, like the sounds of a bank when a cue is created with them
+std::shared_ptr<OggSoundData> SoundManager::getSoundData(handy::StringId aSoundId)
+{
+    auto loaded = mLoadedSounds.find(aSoundId);
+    if (loaded != mLoadedSounds.end())
+    {
+        return loaded->second;
+    }
+
+    auto loader = mSoundLoaders.find(aSoundId);
+    if (loader != mSoundLoaders.end())
+    {
+        std::shared_ptr<OggSoundData> soundData = loader->second();
+
+        if (soundData != nullptr)
+        {
+            addLoadedSound(soundData);
+            return soundData;
+        }
+    }
+
+    return nullptr;
+}
+
+//Sounds not loaded yet are loaded on the loading threads, so playing a cue never decodes on the calling thread
+std::shared_ptr<OggSoundData> SoundManager::requestSoundData(handy::StringId aSoundId)
+{
+    auto loaded = mLoadedSounds.find(aSoundId);
+    if (loaded != mLoadedSounds.end())
+    {
+        return loaded->second;
+    }
+
+    auto loader = mSoundLoaders.find(aSoundId);
+    if (loader != mSoundLoaders.end() && mPendingLoads.try_emplace(aSoundId).second)
+    {
+        spdlog::get("sounds")->info("Loading {} again", handy::revertStringId(aSoundId));
+        //The sound keeps the references it already has
+        pushLoad(aSoundId, loader->second);
+    }
+
+    return nullptr;
+}
+
+LoadingOption SoundManager::getLoadingOption(std::optional<SampleFormat> aSampleFormat) const
+{
+    LoadingOption option = mLoadingOption;
+    option.sampleFormat = aSampleFormat.value_or(mLoadingOption.sampleFormat);
+    return option;
+}
+
+handy::StringId SoundManager::addLoadedSound(const std::shared_ptr<OggSoundData> & aSoundData)
+{
+    if (aSoundData == nullptr)
+    {
+        return handy::StringId::Null();
+    }
+
+    if (mLoadedSounds.insert({aSoundData->soundId, aSoundData}).second)
+    {
+        //Uploaded here since openAL calls are made by the thread calling update()
+        if (!aSoundData->streamedData && aSoundData->fullyDecoded && !aSoundData->staticBuffer.isValid())
+        {
+            const std::span<const std::byte> samples = aSoundData->getDecodedSamples();
+            aSoundData->staticBuffer = StaticBuffer{
+                samples.data(),
+                samples.size(),
+                aSoundData->dataFormat,
+                static_cast<ALsizei>(aSoundData->sampleRate)};
+
+            //Playbacks only queue the static buffer, lengthDecoded still describes the samples
+            if (aSoundData->staticBuffer.isValid() && !mKeepStaticSamples)
+            {
+                aSoundData->decodedData = std::vector<std::byte>{};
+                aSoundData->cachedData = {};
+                aSoundData->cachedDataOwner = nullptr;
+            }
+        }
+
+        mResidentSize += getResidentSize(*aSoundData);
+        mPlayedSoundPositions.insert_or_assign(
+                aSoundData->soundId,
+                mPlayedSounds.insert(mPlayedSounds.end(), aSoundData->soundId));
+    }
+
+    return aSoundData->soundId;
+}
+
+std::size_t SoundManager::eraseLoadedSound(handy::StringId aSoundId)
+{
+    auto loaded = mLoadedSounds.find(aSoundId);
+    if (loaded == mLoadedSounds.end())
+    {
+        return 0;
+    }
+
+    const std::size_t residentSize = getResidentSize(*loaded->second);
+    mResidentSize -= residentSize;
+    mLoadedSounds.erase(loaded);
+
+    auto position = mPlayedSoundPositions.find(aSoundId);
+    mPlayedSounds.erase(position->second);
+    mPlayedSoundPositions.erase(position);
+
+    return residentSize;
+}
+
+//Loads the sound right away, a reloadable sound keeps aLoad to load it again once evicted
+handy::StringId SoundManager::loadSound(handy::StringId aSoundId, SoundLoader aLoad, bool aReloadable)
+{
+    std::shared_ptr<OggSoundData> soundData = aLoad();
+
+    if (soundData == nullptr)
+    {
+        return handy::StringId::Null();
+    }
+
+    if (aReloadable)
+    {
+        mSoundLoaders.insert_or_assign(aSoundId, std::move(aLoad));
+    }
+
+    mSoundReferences[aSoundId]++;
+    return addLoadedSound(soundData);
+}
+
+bool SoundManager::unloadData(handy::StringId aSoundId)
+{
+    auto references = mSoundReferences.find(aSoundId);
+    if (references == mSoundReferences.end())
+    {
+        spdlog::get("sounds")->warn("Cannot unload {}, it is not loaded", handy::revertStringId(aSoundId));
+        return false;
+    }
+
+    if (--references->second > 0)
+    {
+        return false;
+    }
+
+    mSoundReferences.erase(references);
+    mSoundLoaders.erase(aSoundId);
+    const std::size_t residentSize = eraseLoadedSound(aSoundId);
+
+    //The result of the pending load is dropped when it is collected
+    std::vector<LoadingCallback> callbacks;
+    auto pending = mPendingLoads.find(aSoundId);
+    if (pending != mPendingLoads.end())
+    {
+        callbacks = std::move(pending->second);
+        mPendingLoads.erase(pending);
+    }
+
+    for (const LoadingCallback & callback : callbacks)
+    {
+        callback(aSoundId, false);
+    }
+
+    spdlog::get("sounds")->info(
+            "Unloaded {} ({} bytes), {} bytes still loaded",
+            handy::revertStringId(aSoundId), residentSize, mResidentSize);
+
+    return true;
+}
+
+void SoundManager::unloadSounds(const std::vector<handy::StringId> & aSoundIds)
+{
+    for (handy::StringId soundId : aSoundIds)
+    {
+        if (soundId != handy::StringId::Null())
+        {
+            unloadData(soundId);
+        }
+    }
+}
+
+//A reloadable sound keeps aLoad to load it again once evicted
+void SoundManager::loadAsync(
+        handy::StringId aSoundId,
+        SoundLoader aLoad,
+        LoadingCallback aCallback,
+        bool aReloadable)
+{
+    mSoundReferences[aSoundId]++;
+
+    if (mLoadedSounds.contains(aSoundId))
+    {
+        if (aCallback)
+        {
+            aCallback(aSoundId, true);
+        }
+        return;
+    }
+
+    auto [pending, inserted] = mPendingLoads.try_emplace(aSoundId);
+    if (aCallback)
+    {
+        pending->second.push_back(std::move(aCallback));
+    }
+
+    if (!inserted)
+    {
+        //Already loading, the callback is called with the first request
+        return;
+    }
+
+    if (aReloadable)
+    {
+        mSoundLoaders.insert_or_assign(aSoundId, aLoad);
+    }
+
+    pushLoad(aSoundId, std::move(aLoad));
+}
+
+//The result is published by collectLoadResults
+void SoundManager::pushLoad(handy::StringId aSoundId, SoundLoader aLoad)
+{
+    mLoadingPool.push([this, aSoundId, load = std::move(aLoad)]()
+    {
+        std::shared_ptr<OggSoundData> soundData = load();
+        std::scoped_lock lock{mLoadResultsMutex};
+        mLoadResults.push_back({aSoundId, std::move(soundData)});
+    });
+}
+
+//Publishes the sounds loaded by the loading pool and calls their callbacks
+void SoundManager::collectLoadResults()
+{
+    std::vector<std::pair<handy::StringId, std::shared_ptr<OggSoundData>>> loadResults;
+
+    {
+        std::scoped_lock lock{mLoadResultsMutex};
+        loadResults.swap(mLoadResults);
+    }
+
+    for (auto & [soundId, soundData] : loadResults)
+    {
+        auto pending = mPendingLoads.find(soundId);
+        if (pending == mPendingLoads.end())
+        {
+            //Unloaded while it was loading
+            continue;
+        }
+
+        //Callbacks are moved out so they can request other loads
+        std::vector<LoadingCallback> callbacks = std::move(pending->second);
+        mPendingLoads.erase(pending);
+
+        const bool loaded = addLoadedSound(soundData) != handy::StringId::Null();
+
+        if (!loaded)
+        {
+            spdlog::get("sounds")->error("Could not load {}", handy::revertStringId(soundId));
+            mSoundLoaders.erase(soundId);
+            mSoundReferences.erase(soundId);
+        }
+
+        for (const LoadingCallback & callback : callbacks)
+        {
+            callback(soundId, loaded);
+        }
+    }
+}
+
+void SoundManager::resolveLoadingPlaybacks()
+{
+    std::erase_if(mLoadingPlaybacks, [this](const LoadingPlayback & aPlayback)
+    {
+        PlayingSoundCue * cue = findPlayingCue(aPlayback.handle);
+        if (cue == nullptr)
+        {
+            //Stopped while its sounds were loading
+            return true;
+        }
+
+        //Null for the sounds the cue already has
+        std::vector<std::shared_ptr<OggSoundData>> sounds(aPlayback.sounds.size());
+        std::shared_ptr<OggSoundData> interruptSound;
+        bool unloaded = false;
+        bool loading = false;
+        auto findSound = [&](handy::StringId aSoundId, std::shared_ptr<OggSoundData> & aSound)
+        {
+            auto loaded = mLoadedSounds.find(aSoundId);
+            if (loaded != mLoadedSounds.end())
+            {
+                aSound = loaded->second;
+            }
+            else if (mPendingLoads.contains(aSoundId))
+            {
+                loading = true;
+            }
+            else
+            {
+                unloaded = true;
+            }
+        };
+
+        for (std::size_t i = 0; i < aPlayback.sounds.size(); i++)
+        {
+            if (cue->sounds[i].soundData == nullptr)
+            {
+                findSound(aPlayback.sounds[i].first, sounds[i]);
+            }
+        }
+        if (cue->interruptSound.has_value() && cue->interruptSound->soundData == nullptr)
+        {
+            findSound(aPlayback.interruptSound, interruptSound);
+        }
+
+        if (unloaded)
+        {
+            spdlog::get("sounds")->error("Cannot play a cue, one of its sounds could not be loaded again");
+            stopSound(aPlayback.handle);
+            return true;
+        }
+
+        if (loading)
+        {
+            return false;
+        }
+
+        //The cue never had a source, so the feeder thread does not know it yet
+        for (std::size_t i = 0; i < sounds.size(); i++)
+        {
+            if (sounds[i] != nullptr)
+            {
+                cue->sounds[i] = PlayingSound{sounds[i], aPlayback.sounds[i].second};
+                cue->stereo = cue->stereo || sounds[i]->vorbisInfo.channels > 1;
+            }
+        }
+        if (interruptSound != nullptr)
+        {
+            cue->interruptSound.emplace(interruptSound, CueElementOption{});
+            cue->stereo = cue->stereo || interruptSound->vorbisInfo.channels > 1;
+        }
+
+        const std::size_t voice = cue->voice;
+        mVoices.durations[voice] = mVoices.interrupted[voice] ?
+            getSoundDuration(*cue->interruptSound) : getCueDuration(*cue);
+        //update() promotes the voice if it is important enough
+        mVoices.loading[voice] = false;
+        return true;
+    });
+}
+
+namespace {
+
+//Samples per channel held by the ring of a playback
+//A sound of known length does not need more than itself and one frame of slack
+std::size_t getStreamRingSamples(const OggSoundData & aSoundData)
+{
+    if (aSoundData.lengthInSamples == 0)
+    {
+        return STREAMED_RING_SAMPLE;
+    }
+
+    return std::min(STREAMED_RING_SAMPLE, aSoundData.lengthInSamples + MAX_SAMPLES_PER_FRAME);
+}
+
+} // anonymous namespace
+
+void SoundManager::markPlayed(handy::StringId aSoundId)
+{
+    auto position = mPlayedSoundPositions.find(aSoundId);
+    if (position != mPlayedSoundPositions.end())
+    {
+        mPlayedSounds.splice(mPlayedSounds.end(), mPlayedSounds, position->second);
+    }
+}
+
+//Evicts the least recently played sounds until the loaded sounds fit in the memory budget
+//A sound is only evicted when the manager holds its last reference, so no playback
+//or decoding job uses it, and when it can be loaded again
+void SoundManager::evictSounds()
+{
+    auto played = mPlayedSounds.begin();
+
+    while (mMemoryBudget != 0 && mResidentSize > mMemoryBudget && played != mPlayedSounds.end())
+    {
+        handy::StringId soundId = *played;
+        auto loaded = mLoadedSounds.find(soundId);
+
+        //Moves on before eraseLoadedSound removes the sound from the played sounds
+        played++;
+
+        if (loaded->second.use_count() > 1 || !mSoundLoaders.contains(soundId))
+        {
+            continue;
+        }
+
+        const std::size_t residentSize = eraseLoadedSound(soundId);
+
+        spdlog::get("sounds")->info(
+                "Evicted {} ({} bytes), {} bytes still loaded",
+                handy::revertStringId(soundId), residentSize, mResidentSize);
+    }
+}
+
+OggStream::OggStream(const OggSoundData & aSoundData) :
+    vorbisData{nullptr, &stb_vorbis_close},
+    sampleSize{getSampleSize(aSoundData.sampleFormat)},
+    startPosition{aSoundData.lengthDecoded},
+    decodedRing{getStreamRingSamples(aSoundData) * aSoundData.vorbisInfo.channels * sampleSize},
+    lengthDecoded{aSoundData.lengthDecoded}
+{
+    decodedRing.reset(aSoundData.lengthDecoded * sampleSize);
+}
+
+namespace {
+
+//Opens the decoder of aStream at the start of the compressed data
+//Sounds held in memory are decoded in place and seek to aSkippedSamples,
+//the others read a new stream after their headers and decode from the start
+bool openStreamDecoder(OggStream & aStream, const OggSoundData & aData, std::size_t aSkippedSamples)
+{
+    int error = 0;
+    aStream.decoderPosition = 0;
+
+    if (!aData.compressedData.empty())
+    {
+        stb_vorbis * vorbisData = stb_vorbis_open_memory(
+                reinterpret_cast<const unsigned char *>(aData.compressedData.data()),
+                static_cast<int>(aData.compressedData.size()), &error, nullptr);
+
+        if (vorbisData == nullptr)
+        {
+            spdlog::get("sounds")->error("Stb vorbis error while opening memory decoder: {}", error);
+            return false;
+        }
+
+        const unsigned int channels = static_cast<unsigned int>(aData.vorbisInfo.channels);
+        if (aSkippedSamples > 0)
+        {
+            //Without a length, like in truncated files, the decoder cannot seek and drops the samples instead
+            if (stb_vorbis_seek(vorbisData, static_cast<unsigned int>(aSkippedSamples / channels)))
+            {
+                aStream.decoderPosition = aSkippedSamples - aSkippedSamples % channels;
+            }
+            else
+            {
+                stb_vorbis_seek_start(vorbisData);
+            }
+        }
+
+        aStream.vorbisData = {vorbisData, &stb_vorbis_close};
+        aStream.usedData = stb_vorbis_get_file_offset(vorbisData);
+        aStream.undecodedOffset = 0;
+        aStream.lengthRead = aData.compressedData.size();
+        aStream.fullyRead = true;
+        return true;
+    }
+
+    int used = 0;
+    stb_vorbis * vorbisData = stb_vorbis_open_pushdata(
+            reinterpret_cast<const unsigned char *>(aData.headerData.data()),
+            static_cast<int>(aData.headerData.size()), &used, &error, nullptr);
+
+    if (vorbisData == nullptr)
+    {
+        spdlog::get("sounds")->error("Stb vorbis error while opening pushdata decoder: {}", error);
+        return false;
+    }
+
+    aStream.dataStream = aData.openStream();
+    aStream.dataStream->seekg(static_cast<std::streamoff>(aData.headerData.size()));
+    if (aStream.dataStream->fail())
+    {
+        spdlog::get("sounds")->error("Cannot open a stream on {}", handy::revertStringId(aData.soundId));
+        stb_vorbis_close(vorbisData);
+        return false;
+    }
+    aStream.undecodedReadData = aData.headerData;
+
+    aStream.vorbisData = {vorbisData, &stb_vorbis_close};
+    aStream.usedData = static_cast<std::size_t>(used);
+    aStream.undecodedOffset = 0;
+    aStream.lengthRead = aData.headerData.size();
+    aStream.fullyRead = false;
+    return true;
+}
+
+} // anonymous namespace
+
+//Runs on a decoder pool thread, only touches the decoder side of aStream
+//Decodes at least aMinSamples per channel, unless the stream ends,
+//and never more than aMaxSamples decoded values.
+//Decoded values before aSkippedSamples are dropped.
+//A stream read through pushdata cannot seek, so a job drops at most MAX_SKIPPED_SAMPLE_PER_CHUNK
+//per channel and the next jobs carry on from there
+DecodedChunk decodeStreamChunk(
+        const OggSoundData & aData,
+        const std::shared_ptr<OggStream> & aStream,
+        bool aRestart,
+        unsigned int aMinSamples,
+        std::size_t aMaxSamples,
+        std::size_t aSkippedSamples)
+{
+    OggStream & stream = *aStream;
+
+    DecodedChunk chunk{
+        .stream = aStream,
+    };
+
+    if (aRestart && !openStreamDecoder(stream, aData, aSkippedSamples))
+    {
+        //Nothing more can be decoded, the playback ends
+        chunk.fullyDecoded = true;
+        return chunk;
+    }
+
+    stb_vorbis * vorbisData = stream.vorbisData;
+
+    std::vector<char> & soundData = stream.undecodedReadData;
+
+    const int channels = aData.vorbisInfo.channels;
+    const std::size_t maxFrameSamples = MAX_SAMPLES_PER_FRAME * channels;
+    //Samples before this position are played from the sound data or were skipped
+    const std::size_t skippedSamples = aSkippedSamples;
+    const std::size_t maxDroppedSamples = MAX_SKIPPED_SAMPLE_PER_CHUNK * channels;
+
+    int samplesRead = 0;
+    std::size_t droppedSamples = 0;
+    bool ringFull = false;
+
+    //Appends the interleaved values of a frame past the skipped samples
+    auto pushFrame = [&](const float * aSamples, std::size_t aFrameSamples)
+    {
+        const std::size_t dropped = skippedSamples > stream.decoderPosition ?
+            std::min(aFrameSamples, skippedSamples - stream.decoderPosition) : 0;
+        stream.decoderPosition += aFrameSamples;
+        droppedSamples += dropped;
+        samplesRead += static_cast<int>((aFrameSamples - dropped) / channels);
+        appendSamples(chunk.decodedData, aSamples + dropped, aFrameSamples - dropped, aData.sampleFormat);
+    };
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if (!aData.compressedData.empty())
+    {
+        //Sounds held in memory are pulled by the decoder, it seeked when it was opened
+        std::vector<float> frame(maxFrameSamples);
+        while (samplesRead < static_cast<int>(aMinSamples))
+        {
+            if (chunk.decodedData.size() / stream.sampleSize + maxFrameSamples > aMaxSamples)
+            {
+                break;
+            }
+
+            const int frameSampleRead = stb_vorbis_get_samples_float_interleaved(
+                    vorbisData, channels, frame.data(), static_cast<int>(maxFrameSamples));
+
+            if (frameSampleRead <= 0)
+            {
+                spdlog::get("sounds")->info("Fully decoded");
+                chunk.fullyDecoded = true;
+                break;
+            }
+
+            pushFrame(frame.data(), static_cast<std::size_t>(frameSampleRead) * channels);
+        }
+
+        stream.usedData = stb_vorbis_get_file_offset(vorbisData);
+    }
+    else
+    {
+        std::size_t used = stream.usedData;
+        float ** output;
+
+        while (samplesRead < static_cast<int>(aMinSamples)) {
+            int currentUsed = -1;
+
+            while (currentUsed != 0)
+            {
+                if (chunk.decodedData.size() / stream.sampleSize + maxFrameSamples > aMaxSamples
+                        || droppedSamples >= maxDroppedSamples)
+                {
+                    ringFull = true;
+                    break;
+                }
+
+                int frameChannels = 0;
+                int passSampleRead = 0;
+                const std::size_t windowUsed = used - stream.undecodedOffset;
+
+                currentUsed = stb_vorbis_decode_frame_pushdata(
+                    vorbisData, reinterpret_cast<const unsigned char *>(soundData.data() + windowUsed),
+                    static_cast<int>(soundData.size() - windowUsed),
+                    &frameChannels, &output, &passSampleRead);
+
+                used += currentUsed;
+
+                if (passSampleRead > 0)
+                {
+                    if (frameChannels == 2)
+                    {
+                        std::vector<float> interleavedData = interleave(
+                                output[0], output[1], passSampleRead);
+                        pushFrame(interleavedData.data(), interleavedData.size());
+                    }
+                    else
+                    {
+                        pushFrame(output[0], static_cast<std::size_t>(passSampleRead));
+                    }
+                }
+            }
+
+            if (ringFull)
+            {
+                break;
+            }
+
+            if (!stream.fullyRead)
+            {
+                //Recycle the decoded bytes before reading more
+                soundData.erase(soundData.begin(), soundData.begin() + (used - stream.undecodedOffset));
+                stream.undecodedOffset = used;
+
+                std::array<char, READ_CHUNK_SIZE> moreHeaderData;
+                stream.dataStream->read(moreHeaderData.data(), READ_CHUNK_SIZE);
+                std::streamsize lengthRead = stream.dataStream->gcount();
+                soundData.insert(
+                        soundData.end(), moreHeaderData.begin(), moreHeaderData.begin() + lengthRead);
+                spdlog::get("sounds")->info("Reading new chunk from {} to {}", stream.lengthRead, stream.lengthRead + lengthRead);
+                stream.lengthRead += lengthRead;
+
+                if (lengthRead < READ_CHUNK_SIZE)
+                {
+                    stream.fullyRead = true;
+                }
+            }
+
+            if (stream.fullyRead && used == stream.lengthRead)
+            {
+                spdlog::get("sounds")->info("Fully decoded");
+                chunk.fullyDecoded = true;
+                break;
+            }
+        }
+
+        stream.usedData = used;
+    }
+
+    std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> diff = after - now;
+
+    spdlog::get("sounds")->info("Samples: {}, total used bytes: {}, Elapsed time: {}", samplesRead, stream.usedData, diff.count());
+
+    return chunk;
+}
+
+void commitDecodedChunk(DecodedChunk && aChunk)
+{
+    OggStream & stream = *aChunk.stream;
+    stream.decodePending = false;
+
+    if (stream.discardPendingChunk)
+    {
+        stream.discardPendingChunk = false;
+        return;
+    }
+
+    stream.decodedRing.push(aChunk.decodedData.data(), aChunk.decodedData.size());
+    stream.lengthDecoded = stream.decodedRing.getEnd() / stream.sampleSize;
+    stream.fullyDecoded = aChunk.fullyDecoded;
+}
+
+//Restarts the playback stream right after the first samples of the sound data
+void rewindStream(OggStream & aStream, const OggSoundData & aData)
+{
+    seekStream(aStream, aData, aData.lengthDecoded);
+}
+
+//Sounds held in memory seek when their decoder is opened again,
+//the others decode the stream from its start and drop the samples up to aPosition
+void seekStream(OggStream & aStream, const OggSoundData &, std::size_t aPosition)
+{
+    aStream.startPosition = aPosition;
+    aStream.decodedRing.reset(aPosition * aStream.sampleSize);
+    aStream.lengthDecoded = aPosition;
+    aStream.fullyDecoded = false;
+    aStream.restartDecoder = true;
+    aStream.discardPendingChunk = aStream.decodePending;
+}
+
+std::size_t getResidentSize(const OggSoundData & aData)
+{
+    //Other streamed sounds read their compressed data from a stream or a file mapping
+    const std::size_t compressedSize = aData.compressedResident ? aData.compressedData.size() : 0;
+    return aData.getDecodedSamples().size() + aData.staticBuffer.getSize() + aData.headerData.size() + compressedSize;
+}
+
+void SoundManager::requestDecode(const PlayingSound & aSound, unsigned int aMinSamples)
+{
+    const std::shared_ptr<OggStream> & stream = aSound.stream;
+
+    if (stream == nullptr
+            || stream->decodePending
+            || stream->fullyDecoded
+            || stream->decodedRing.getFreeSpace() / stream->sampleSize
+                < MAX_SAMPLES_PER_FRAME * aSound.soundData->vorbisInfo.channels)
+    {
+        return;
+    }
+
+    //The ring only gets more free space until the chunk is committed
+    const std::size_t maxSamples = stream->decodedRing.getFreeSpace() / stream->sampleSize;
+    const bool restart = stream->restartDecoder;
+    const std::size_t skippedSamples = stream->startPosition;
+    stream->restartDecoder = false;
+
+    if (mDecoderPool.getThreadCount() == 0)
+    {
+        commitDecodedChunk(decodeStreamChunk(
+                    *aSound.soundData, stream, restart, aMinSamples, maxSamples, skippedSamples));
+        return;
+    }
+
+    stream->decodePending = true;
+    mDecoderPool.push([this, data = aSound.soundData, stream, restart, aMinSamples, maxSamples, skippedSamples]()
+    {
+        DecodedChunk chunk = decodeStreamChunk(*data, stream, restart, aMinSamples, maxSamples, skippedSamples);
+        std::scoped_lock lock{mDecodedChunksMutex};
+        mDecodedChunks.push_back(std::move(chunk));
+    });
+}
+
+void SoundManager::collectDecodedChunks()
+{
+    std::vector<DecodedChunk> decodedChunks;
+
+    {
+        std::scoped_lock lock{mDecodedChunksMutex};
+        decodedChunks.swap(mDecodedChunks);
+    }
+
+    for (DecodedChunk & chunk : decodedChunks)
+    {
+        commitDecodedChunk(std::move(chunk));
+    }
+}
+
+
+ALint SoundManager::getSourceState(ALuint aSource)
+{
+    ALint sourceState;
+    alCall(alGetSourcei, aSource, AL_SOURCE_STATE, &sourceState);
+    return sourceState;
+}
+
+namespace {
+
+//Seconds of one pass of a sound, infinite when the length of its stream is not known
+float getPassDuration(const OggSoundData & aData)
+{
+    std::size_t samples = 0;
+    if (aData.fullyDecoded)
+    {
+        samples = aData.lengthDecoded / aData.vorbisInfo.channels;
+    }
+    else if (aData.lengthInSamples != 0)
+    {
+        samples = aData.lengthInSamples;
+    }
+    else
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    return static_cast<float>(samples) / aData.vorbisInfo.sample_rate;
+}
+
+void rewindPlayingSound(PlayingSound & aSound)
+{
+    aSound.loops = aSound.loopCount;
+    aSound.positionInData = 0;
+    aSound.state = PlayingSoundState_WAITING;
+    aSound.freeBuffers = aSound.buffers;
+    aSound.stagedBuffers.clear();
+
+    if (aSound.stream != nullptr)
+    {
+        rewindStream(*aSound.stream, *aSound.soundData);
+    }
+}
+
+//Moves a rewound sound aCursor seconds into its passes.
+//Returns false when the cursor is past the sound, aCursor is then reduced by the sound duration.
+//Otherwise aSampleOffset is the sample, per channel, where the current pass resumes
+bool seekPlayingSound(PlayingSound & aSound, float & aCursor, std::size_t & aSampleOffset)
+{
+    const OggSoundData & data = *aSound.soundData;
+    const float passDuration = getPassDuration(data);
+    const float duration = getSoundDuration(aSound);
+
+    if (aCursor >= duration)
+    {
+        aCursor -= duration;
+        aSound.state = PlayingSoundState_FINISHED;
+        return false;
+    }
+
+    float offset = aCursor;
+    if (!std::isinf(passDuration) && passDuration > 0.f)
+    {
+        const int passes = static_cast<int>(aCursor / passDuration);
+        offset -= passes * passDuration;
+        if (aSound.loops > 0)
+        {
+            aSound.loops -= passes;
+        }
+    }
+
+    aSampleOffset = static_cast<std::size_t>(offset * data.vorbisInfo.sample_rate);
+    aSound.positionInData = aSampleOffset * data.vorbisInfo.channels;
+
+    if (aSound.stream != nullptr && aSound.positionInData > data.lengthDecoded)
+    {
+        seekStream(*aSound.stream, data, aSound.positionInData);
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+float getSoundDuration(const PlayingSound & aSound)
+{
+    const float passDuration = getPassDuration(*aSound.soundData);
+    if (aSound.loopCount < 0 || std::isinf(passDuration))
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    return passDuration * static_cast<float>(aSound.loopCount + 1);
+}
+
+float getCueDuration(const PlayingSoundCue & aCue)
+{
+    float duration = 0.f;
+    for (const PlayingSound & sound : aCue.sounds)
+    {
+        duration += getSoundDuration(sound);
+    }
+
+    return duration;
+}
+
+void SoundManager::update()
+{
+    collectLoadResults();
+    //Before eviction, which could take back a sound that was just loaded for them
+    resolveLoadingPlaybacks();
+    evictSounds();
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const std::chrono::duration<float> elapsed = now - mLastUpdate;
+    mLastUpdate = now;
+
+    if (mThreadedFeeding)
+    {
+        flushFeederCommands();
+
+        FinishedCue finishedCue;
+        while (mFinishedCues.pop(finishedCue))
+        {
+            //The voice may have been demoted and promoted again since the cue finished
+            const PlayingSoundCue * cue = findPlayingCue(finishedCue.handle);
+            if (cue != nullptr && mVoices.promotions[cue->voice] == finishedCue.promotion)
+            {
+                stopSound(finishedCue.handle);
+            }
+        }
+
+        advanceVoices(elapsed.count());
+        scoreVoices();
+        assignSources();
+
+        for (std::size_t voice = 0; voice < mVoices.size(); voice++)
+        {
+            if (!mVoices.isVirtual(voice))
+            {
+                applyVoiceOption(voice);
+            }
+        }
+
+        releaseStoppedCues();
+        return;
+    }
+
+    collectDecodedChunks();
+
+    spdlog::get("sounds")->trace("# free sources: {} mono, {} stereo", mFreeMonoSources.size(), mFreeStereoSources.size());
+    spdlog::get("sounds")->trace("# playing sound: {}", mVoices.size());
+    spdlog::get("sounds")->trace("# number of prioriry queue: {}", mCuesByCategories.size());
+
+    for (auto & [cat, queue] : mCuesByCategories)
+    {
+        spdlog::get("sounds")->trace("# number sound in priority queue {}: {}", cat, queue.size());
+    }
+
+    advanceVoices(elapsed.count());
+    scoreVoices();
+    assignSources();
+
+    //Backward so a cue stopped by updateCue only moves a voice already updated in its place
+    for (std::size_t voice = mVoices.size(); voice-- > 0;)
+    {
+        if (!mVoices.isVirtual(voice))
+        {
+            updateCue(*mVoices.cues[voice], mVoices.handles[voice]);
+        }
+    }
+
+    releaseStoppedCues();
+}
+
+//Moves the cursor of the playing voices, a virtual voice past its duration is over
+void SoundManager::advanceVoices(float aElapsed)
+{
+    for (std::size_t voice = mVoices.size(); voice-- > 0;)
+    {
+        if (mVoices.states[voice] == VoiceState_PLAYING && !mVoices.loading[voice])
+        {
+            mVoices.cursors[voice] += aElapsed;
+
+            if (mVoices.isVirtual(voice) && mVoices.cursors[voice] >= mVoices.durations[voice])
+            {
+                stopSound(mVoices.handles[voice]);
+            }
+        }
+    }
+}
+
+namespace {
+
+//Sources are relative to the listener, so the distance is the length of the position
+float getDistanceAttenuation(const math::Position<3, float> & aPosition)
+{
+    const float distance = std::max(
+            std::sqrt(aPosition.x() * aPosition.x() + aPosition.y() * aPosition.y() + aPosition.z() * aPosition.z()),
+            REFERENCE_DISTANCE);
+    return REFERENCE_DISTANCE / (REFERENCE_DISTANCE + ROLLOFF_FACTOR * (distance - REFERENCE_DISTANCE));
+}
+
+} // anonymous namespace
+
+float SoundManager::getCategoryGain(SoundCategory aCategory) const
+{
+    const CategoryOption & catOption = mCategoryOptions.at(aCategory);
+    const CategoryOption & masterOption = mCategoryOptions.at(MASTER_SOUND_CATEGORY);
+    return catOption.userGain * catOption.gameGain * masterOption.userGain * masterOption.gameGain;
+}
+
+float SoundManager::getVoiceGain(std::size_t aVoice) const
+{
+    return mVoices.gains[aVoice] * getCategoryGain(mVoices.categories[aVoice]);
+}
+
+void SoundManager::scoreVoices()
+{
+    const bool limited = mVoiceLimitRadius > 0.f;
+    if (limited)
+    {
+        mVoiceGrid.clear();
+    }
+
+    for (std::size_t voice = 0; voice < mVoices.size(); voice++)
+    {
+        mVoices.audibilities[voice] = getVoiceGain(voice) * getDistanceAttenuation(mVoices.positions[voice]);
+
+        if (limited && mVoices.states[voice] == VoiceState_PLAYING)
+        {
+            mVoiceGrid.insert(mVoices.positions[voice], mVoices.handles[voice]);
+        }
+    }
+}
+
+//The audible playing voices with the best priority get the sources,
+//the most audible first among voices of the same priority.
+//Voices holding a source win ties so they do not swap every update.
+//Inaudible voices always give their source back,
+//paused voices and outranked voices only when it is needed
+void SoundManager::assignSources()
+{
+    mRankedVoices.clear();
+    for (std::size_t voice = 0; voice < mVoices.size(); voice++)
+    {
+        if (mVoices.states[voice] != VoiceState_PLAYING || mVoices.loading[voice])
+        {
+            continue;
+        }
+
+        if (mVoices.audibilities[voice] >= mInaudibleGain)
+        {
+            mRankedVoices.push_back(voice);
+        }
+        else if (!mVoices.isVirtual(voice))
+        {
+            demoteVoice(voice);
+        }
+    }
+
+    //Mono and stereo voices compete for their own sources
+    const auto stereoBegin = std::partition(mRankedVoices.begin(), mRankedVoices.end(), [this](std::size_t aVoice)
+    {
+        return !mVoices.cues[aVoice]->stereo;
+    });
+    assignSources(mRankedVoices.begin(), stereoBegin, false);
+    assignSources(stereoBegin, mRankedVoices.end(), true);
+}
+
+void SoundManager::assignSources(
+        std::vector<std::size_t>::iterator aBegin,
+        std::vector<std::size_t>::iterator aEnd,
+        bool aStereo)
+{
+    std::vector<std::size_t> & freeSources = getFreeSources(aStereo);
+    const std::size_t sourceCount = aStereo ? mSources.size() - mMonoSourceCount : mMonoSourceCount;
+    const std::size_t realCount = std::min(sourceCount, static_cast<std::size_t>(aEnd - aBegin));
+    const auto realEnd = aBegin + realCount;
+
+    if (static_cast<std::size_t>(aEnd - aBegin) > realCount)
+    {
+        std::nth_element(aBegin, realEnd, aEnd,
+                [this](std::size_t aLhs, std::size_t aRhs)
+                {
+                    if (mVoices.priorities[aLhs] != mVoices.priorities[aRhs])
+                    {
+                        return mVoices.priorities[aLhs] < mVoices.priorities[aRhs];
+                    }
+
+                    if (mVoices.audibilities[aLhs] != mVoices.audibilities[aRhs])
+                    {
+                        return mVoices.audibilities[aLhs] > mVoices.audibilities[aRhs];
+                    }
+
+                    return !mVoices.isVirtual(aLhs) && mVoices.isVirtual(aRhs);
+                });
+    }
+
+    const std::size_t promotions = std::count_if(aBegin, realEnd, [this](std::size_t aVoice)
+    {
+        return mVoices.isVirtual(aVoice);
+    });
+
+    if (promotions == 0)
+    {
+        return;
+    }
+
+    for (std::size_t voice = 0; voice < mVoices.size() && freeSources.size() < promotions; voice++)
+    {
+        if (mVoices.states[voice] == VoiceState_PAUSED
+                && !mVoices.isVirtual(voice)
+                && mVoices.cues[voice]->stereo == aStereo)
+        {
+            demoteVoice(voice);
+        }
+    }
+
+    for (auto voice = realEnd; voice != aEnd && freeSources.size() < promotions; voice++)
+    {
+        if (!mVoices.isVirtual(*voice))
+        {
+            demoteVoice(*voice);
+        }
+    }
+
+    for (auto voice = aBegin; voice != realEnd; voice++)
+    {
+        if (mVoices.isVirtual(*voice))
+        {
+            const std::size_t sourceIndex = freeSources.back();
+            freeSources.pop_back();
+            promoteVoice(*voice, sourceIndex);
+        }
+    }
+}
+
+namespace {
+
+void applySourceOption(ALuint aSource, const SoundOption & aOption)
+{
+    //updating position and velocity
+    const math::Position<3, float> & position = aOption.position;
+    const math::Vec<3, float> & velocity = aOption.velocity;
+    alCall(alSource3f, aSource, AL_POSITION, position.x(), position.y(), position.z());
+    alCall(alSource3f, aSource, AL_VELOCITY, velocity.x(), velocity.y(), velocity.z());
+
+    alCall(alSourcef, aSource, AL_GAIN, aOption.gain);
+}
+
+} // anonymous namespace
+
+//The cue starts from the cursor of its voice, its source is placed before it plays
+void SoundManager::promoteVoice(std::size_t aVoice, std::size_t aSourceIndex)
+{
+    const ALuint source = mSources.at(aSourceIndex);
+    const Handle<PlayingSoundCue> & handle = mVoices.handles[aVoice];
+    mVoices.sources[aVoice] = source;
+    mVoices.sourceSlots[aVoice] = aSourceIndex;
+    mVoices.optionsChanged[aVoice] = false;
+    mVoices.promotions[aVoice]++;
+    mSourceOwners[aSourceIndex] = handle;
+
+    if (mThreadedFeeding)
+    {
+        pushFeederCommand({
+                .type = FeederCommandType_PLAY,
+                .handle = handle,
+                .cue = *mPlayingCues.find(handle),
+                .source = source,
+                .cursor = mVoices.cursors[aVoice],
+                .interrupted = mVoices.interrupted[aVoice],
+                .promotion = mVoices.promotions[aVoice],
+                .option = getSourceOption(aVoice)});
+    }
+    else
+    {
+        applySourceOption(source, getSourceOption(aVoice));
+        //A cue already over is stopped by updateCue
+        startCue(*mVoices.cues[aVoice], source, mVoices.cursors[aVoice], mVoices.interrupted[aVoice]);
+    }
+}
+
+//The voice keeps its cursor, the cue is started again from it once promoted
+void SoundManager::demoteVoice(std::size_t aVoice)
+{
+    const ALuint source = mVoices.sources[aVoice];
+    const Handle<PlayingSoundCue> & handle = mVoices.handles[aVoice];
+
+    if (mThreadedFeeding)
+    {
+        pushFeederCommand({FeederCommandType_STOP, handle, *mPlayingCues.find(handle)});
+    }
+    else
+    {
+        PlayingSoundCue & cue = *mVoices.cues[aVoice];
+        alCall(alSourceStop, source);
+        alCall(alSourcei, source, AL_BUFFER, NULL);
+        cue.releaseBuffers(mBufferPool);
+        cue.source = NO_SOURCE;
+        cue.state = PlayingSoundCueState_NOT_PLAYING;
+    }
+
+    releaseSource(mVoices.sourceSlots[aVoice]);
+    mVoices.sources[aVoice] = NO_SOURCE;
+}
+
+void SoundManager::releaseSource(std::size_t aSourceIndex)
+{
+    mSourceOwners[aSourceIndex] = Handle<PlayingSoundCue>();
+    getFreeSources(aSourceIndex >= mMonoSourceCount).push_back(aSourceIndex);
+}
+
+void SoundManager::releaseStoppedCues()
+{
+    for (const Handle<PlayingSoundCue> & handle : mStoppedCues)
+    {
+        mPlayingCues.erase(handle);
+    }
+    mStoppedCues.clear();
+}
+
+void SoundManager::monitor()
+{
+    for (ALuint source : mVoices.sources)
+    {
+        if (source == NO_SOURCE)
+        {
+            continue;
+        }
+
+        ALint sourceState;
+        alCall(alGetSourcei, source, AL_SOURCE_STATE, &sourceState);
+        spdlog::get("sounds")->trace("Source state {}", sourceState);
+    }
+}
+
+void SoundManager::pushFeederCommand(const FeederCommand & aCommand)
+{
+    if (flushFeederCommands() && mFeederCommands.push(aCommand))
+    {
+        return;
+    }
+
+    if (mOverflowFeederCommands.empty())
+    {
+        spdlog::get("sounds")->warn("Feeder command queue is full, commands wait for the next update");
+    }
+    mOverflowFeederCommands.push_back(aCommand);
+}
+
+bool SoundManager::flushFeederCommands()
+{
+    while (!mOverflowFeederCommands.empty())
+    {
+        if (!mFeederCommands.push(mOverflowFeederCommands.front()))
+        {
+            return false;
+        }
+        mOverflowFeederCommands.pop_front();
+    }
+
+    return true;
+}
+
+//Feeder thread loop, owns the streaming state of the cues it was sent
+void SoundManager::feed()
+{
+    std::vector<std::pair<FinishedCue, std::shared_ptr<PlayingSoundCue>>> fedCues;
+    //Reports that did not fit in the queue, sent in order on the next ticks
+    //so the game thread always ends up stopping the cue and giving back its source
+    std::vector<FinishedCue> unreportedCues;
+    auto reportFinished = [this, &unreportedCues](const FinishedCue & aFinishedCue)
+    {
+        if (!unreportedCues.empty() || !mFinishedCues.push(aFinishedCue))
+        {
+            unreportedCues.push_back(aFinishedCue);
+        }
+    };
+
+    while (mFeeding)
+    {
+        std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+
+        const auto reported = std::find_if_not(unreportedCues.begin(), unreportedCues.end(),
+                [this](const FinishedCue & aFinishedCue)
+                {
+                    return mFinishedCues.push(aFinishedCue);
+                });
+        unreportedCues.erase(unreportedCues.begin(), reported);
+
+        collectDecodedChunks();
+
+        FeederCommand command;
+        while (mFeederCommands.pop(command))
+        {
+            PlayingSoundCue & cue = *command.cue;
+
+            switch (command.type)
+            {
+                case FeederCommandType_PLAY:
+                    applySourceOption(command.source, command.option);
+                    if (startCue(cue, command.source, command.cursor, command.interrupted))
+                    {
+                        fedCues.push_back({{command.handle, command.promotion}, command.cue});
+                    }
+                    else
+                    {
+                        reportFinished({command.handle, command.promotion});
+                    }
+                    break;
+                case FeederCommandType_STOP:
+                    alCall(alSourceStop, cue.source);
+                    alCall(alSourcei, cue.source, AL_BUFFER, NULL);
+                    cue.releaseBuffers(mBufferPool);
+                    cue.source = NO_SOURCE;
+                    std::erase_if(fedCues, [&command](const auto & fedCue)
+                    {
+                        return fedCue.second == command.cue;
+                    });
+                    break;
+                case FeederCommandType_PAUSE:
+                    cue.paused = true;
+                    alCall(alSourcePause, cue.source);
+                    break;
+                case FeederCommandType_START:
+                    cue.paused = false;
+                    alCall(alSourcePlay, cue.source);
+                    break;
+                case FeederCommandType_INTERRUPT:
+                    interruptCue(cue);
+                    break;
+                case FeederCommandType_OPTION:
+                    //Only sent for cues holding a source, it follows their PLAY command
+                    applySourceOption(cue.source, command.option);
+                    break;
+            }
+        }
+
+        for (const auto & [finishedCue, cue] : fedCues)
+        {
+            //A finished cue stays fed until the game thread stops it
+            if (cue->state != PlayingSoundCueState_NOT_PLAYING && feedCue(*cue))
+            {
+                reportFinished(finishedCue);
+            }
+        }
+
+        std::this_thread::sleep_until(tickStart + mFeedingPeriod);
+    }
+}
+
+bool SoundManager::interruptCue(PlayingSoundCue & aCue)
+{
+    //Free buffer of waiting and pending sound
+    PlayingSound & waitingSound = aCue.getWaitingSound();
+    waitingSound.stagedBuffers.resize(0);
+    waitingSound.freeBuffers.assign(waitingSound.buffers.begin(), waitingSound.buffers.end());
+    PlayingSound & playingSound = aCue.getPlayingSound();
+    playingSound.stagedBuffers.resize(0);
+    playingSound.freeBuffers.assign(playingSound.buffers.begin(), playingSound.buffers.end());
+
+    aCue.state = PlayingSoundCueState_INTERRUPTED;
+    PlayingSound & sound = *aCue.interruptSound;
+    sound.state = PlayingSoundState_PLAYING;
+    primeStreamedSound(sound);
+    prepareStreamedSound(sound);
+    bufferPlayingSound(sound);
+    //Stop source to swap buffer
+    alCall(alSourceStop, aCue.source);
+    //Clean buffer queue to avoid processing of interrupted sound
+    alCall(alSourcei, aCue.source, AL_BUFFER, NULL);
+
+    //Nothing is staged while the decoder has not delivered the interrupt sound,
+    //feedCue queues it and restarts the stopped source once it has
+    if (sound.stagedBuffers.empty())
+    {
+        return true;
+    }
+
+    alCall(alSourceQueueBuffers, aCue.source, sound.stagedBuffers.size(), sound.stagedBuffers.data());
+    sound.stagedBuffers.resize(0);
+    return alCall(alSourcePlay, aCue.source);
+}
+
+//Handles made by another manager resolve to nullptr
+PlayingSoundCue * SoundManager::findPlayingCue(const Handle<PlayingSoundCue> & aHandle) const
+{
+    const std::shared_ptr<PlayingSoundCue> * cue = mPlayingCues.find(aHandle);
+    return cue != nullptr ? cue->get() : nullptr;
+}
+
+bool SoundManager::interruptSound(const Handle<PlayingSoundCue> & aHandle)
+{
+    PlayingSoundCue * cue = findPlayingCue(aHandle);
+    if (cue != nullptr)
+    {
+        if (cue->interruptSound.has_value())
+        {
+            //A virtual voice starts the interrupt sound once promoted
+            const std::size_t voice = cue->voice;
+            mVoices.interrupted[voice] = true;
+            mVoices.cursors[voice] = 0.f;
+            //A loading voice gets its duration once its sounds are loaded
+            if (!mVoices.loading[voice])
+            {
+                mVoices.durations[voice] = getSoundDuration(*cue->interruptSound);
+            }
+
+            if (mVoices.isVirtual(voice))
+            {
+                return true;
+            }
+
+            if (mThreadedFeeding)
+            {
+                pushFeederCommand({FeederCommandType_INTERRUPT, aHandle, *mPlayingCues.find(aHandle)});
+                return true;
+            }
+
+            return interruptCue(*cue);
+        }
+        else
+        {
+            return stopSound(aHandle);
+        }
+    }
+
+    return false;
+}
+
+bool SoundManager::setSoundOption(const Handle<PlayingSoundCue> & aHandle, const SoundOption & aOption)
+{
+    PlayingSoundCue * cue = findPlayingCue(aHandle);
+    if (cue == nullptr)
+    {
+        return false;
+    }
+
+    mVoices.setOption(cue->voice, aOption);
+    return true;
 }
 
-void SoundManager::monitor()
+std::optional<SoundOption> SoundManager::getSoundOption(const Handle<PlayingSoundCue> & aHandle) const
 {
-    for (const auto & [handle, currentCue] : mPlayingCues)
+    PlayingSoundCue * cue = findPlayingCue(aHandle);
+    if (cue == nullptr)
     {
-        ALint sourceState;
-        alCall(alGetSourcei, currentCue->source, AL_SOURCE_STATE, &sourceState);
-        spdlog::get("sounds")->trace("Source state {}", sourceState);
+        return std::nullopt;
     }
+
+    return mVoices.getOption(cue->voice);
 }
 
-bool SoundManager::interruptSound(const Handle<PlayingSoundCue> & aHandle)
+bool SoundManager::setSoundPriority(const Handle<PlayingSoundCue> & aHandle, int aPriority)
 {
-    PlayingSoundCue * cue = aHandle.toObject();
+    PlayingSoundCue * cue = findPlayingCue(aHandle);
+
     if (cue != nullptr)
     {
-        if (cue->interruptSound != nullptr)
-        {
-            //Free buffer of waiting and pending sound
-            std::shared_ptr<PlayingSound> waitingSound = cue->getWaitingSound();
-            waitingSound->stagedBuffers.resize(0);
-            waitingSound->freeBuffers.assign(waitingSound->buffers.begin(), waitingSound->buffers.end());
-            std::shared_ptr<PlayingSound> playingSound = cue->getPlayingSound();
-            playingSound->stagedBuffers.resize(0);
-            playingSound->freeBuffers.assign(waitingSound->buffers.begin(), waitingSound->buffers.end());
-
-            cue->state = PlayingSoundCueState_INTERRUPTED;
-            std::shared_ptr<PlayingSound> sound = cue->interruptSound;
-            std::shared_ptr<OggSoundData> data = sound->soundData;
-            if (data->lengthDecoded < sound->positionInData + MINIMUM_SAMPLE_BUFFERED_ON_CREATION && !data->fullyDecoded)
-            {
-                decodeSoundData(data, MINIMUM_SAMPLE_BUFFERED_ON_CREATION);
-            }
-            bufferPlayingSound(sound);
-            //Stop source to swap buffer
-            alCall(alSourceStop, cue->source);
-            //Clean buffer queue to avoid processing of interrupted sound
-            alCall(alSourcei, cue->source, AL_BUFFER, NULL);
-            alCall(alSourceQueueBuffers, cue->source, 1, sound->stagedBuffers.data());
-            return alCall(alSourcePlay, cue->source);
-
-            sound->stagedBuffers.erase(sound->stagedBuffers.begin());
-            if (sound->stagedBuffers.size() > 0)
-            {
-                alCall(alSourceQueueBuffers, cue->source, sound->stagedBuffers.size(), sound->stagedBuffers.data());
-            }
-        }
-        else
-        {
-            return stopSound(aHandle);
-        }
+        //The cue keeps its initial priority, the feeder thread may own it
+        mVoices.priorities[cue->voice] = aPriority;
+        return mCuesByCategories.at(cue->category).setPriority(aHandle, aPriority);
     }
 
     return false;
@@ -444,40 +2509,54 @@ bool SoundManager::interruptSound(const Handle<PlayingSoundCue> & aHandle)
 bool SoundManager::stopSound(const Handle<PlayingSoundCue> & aHandle)
 {
 
-    PlayingSoundCue * cue = aHandle.toObject();
+    PlayingSoundCue * cue = findPlayingCue(aHandle);
 
     if (cue != nullptr)
     {
-        PlayingSoundCueQueue & cueQueue = mCuesByCategories.at(cue->category);
-        std::erase(cueQueue, aHandle);
-        std::make_heap(cueQueue.begin(), cueQueue.end(), CmpHandlePriority);
+        mCuesByCategories.at(cue->category).erase(aHandle);
 
-        for (std::size_t i = 0; i < mSources.size(); i++)
+        const std::size_t voice = cue->voice;
+        bool result = true;
+
+        if (!mVoices.isVirtual(voice))
         {
-            if (mSources.at(i) == cue->source)
+            const ALuint source = mVoices.sources[voice];
+            releaseSource(mVoices.sourceSlots[voice]);
+
+            if (mThreadedFeeding)
             {
-                mFreeSources.push_back(i);
-                break;
+                pushFeederCommand({FeederCommandType_STOP, aHandle, *mPlayingCues.find(aHandle)});
+            }
+            else
+            {
+                result = alCall(alSourceStop, source);
+                alCall(alSourcei, source, AL_BUFFER, NULL);
+                cue->releaseBuffers(mBufferPool);
             }
         }
 
-
-        bool result = alCall(alSourceStop, cue->source);
-        alCall(alSourcei, cue->source, AL_BUFFER, NULL);
-        mPlayingCues.at(aHandle) = nullptr;
+        mVoices.erase(voice);
+        *mPlayingCues.find(aHandle) = nullptr;
+        mStoppedCues.push_back(aHandle);
         return result;
     }
 
     return false;
 }
 
+//The least important playbacks are stopped first
 void SoundManager::stopCategory(SoundCategory aSoundCategory)
 {
-    const PlayingSoundCueQueue & soundQueue = mCuesByCategories.at(aSoundCategory);
+    PlayingSoundCueQueue & soundQueue = mCuesByCategories.at(aSoundCategory);
 
-    for (const Handle<PlayingSoundCue> & handle : soundQueue)
+    while (!soundQueue.empty())
     {
-        stopSound(handle);
+        //stopSound removes the playback from the queue, the handle is copied before
+        const Handle<PlayingSoundCue> handle = soundQueue.top().handle;
+        if (!stopSound(handle))
+        {
+            soundQueue.erase(handle);
+        }
     }
 }
 
@@ -490,10 +2569,25 @@ void SoundManager::stopAllSound()
 }
 
 bool SoundManager::pauseSound(const Handle<PlayingSoundCue> & aHandle) {
-    PlayingSoundCue * cue = aHandle.toObject();
+    PlayingSoundCue * cue = findPlayingCue(aHandle);
     if (cue != nullptr)
     {
-        return alCall(alSourcePause, cue->source);
+        const std::size_t voice = cue->voice;
+        mVoices.states[voice] = VoiceState_PAUSED;
+
+        if (mVoices.isVirtual(voice))
+        {
+            return true;
+        }
+
+        if (mThreadedFeeding)
+        {
+            pushFeederCommand({FeederCommandType_PAUSE, aHandle, *mPlayingCues.find(aHandle)});
+            return true;
+        }
+
+        cue->paused = true;
+        return alCall(alSourcePause, mVoices.sources[voice]);
     }
 
     return false;
@@ -504,7 +2598,7 @@ std::vector<Handle<PlayingSoundCue>> SoundManager::pauseCategory(SoundCategory a
     std::vector<Handle<PlayingSoundCue>> result;
     const PlayingSoundCueQueue & soundQueue = mCuesByCategories.at(aSoundCategory);
 
-    for (const Handle<PlayingSoundCue> & handle : soundQueue)
+    for (const auto & [priority, handle] : soundQueue)
     {
         if(pauseSound(handle))
         {
@@ -532,11 +2626,27 @@ std::vector<Handle<PlayingSoundCue>> SoundManager::pauseAllSound()
 
 bool SoundManager::startSound(const Handle<PlayingSoundCue> & aHandle)
 {
-    PlayingSoundCue * cue = aHandle.toObject();
+    PlayingSoundCue * cue = findPlayingCue(aHandle);
 
     if (cue != nullptr)
     {
-        return alCall(alSourcePlay, cue->source);
+        //A virtual voice is promoted by update() if it is important enough
+        const std::size_t voice = cue->voice;
+        mVoices.states[voice] = VoiceState_PLAYING;
+
+        if (mVoices.isVirtual(voice))
+        {
+            return true;
+        }
+
+        if (mThreadedFeeding)
+        {
+            pushFeederCommand({FeederCommandType_START, aHandle, *mPlayingCues.find(aHandle)});
+            return true;
+        }
+
+        cue->paused = false;
+        return alCall(alSourcePlay, mVoices.sources[voice]);
     }
 
     return false;
@@ -546,7 +2656,7 @@ void SoundManager::startCategory(SoundCategory aSoundCategory)
 {
     const PlayingSoundCueQueue & soundQueue = mCuesByCategories.at(aSoundCategory);
 
-    for (const Handle<PlayingSoundCue> & handle : soundQueue)
+    for (const auto & [priority, handle] : soundQueue)
     {
         startSound(handle);
     }
@@ -567,32 +2677,21 @@ Handle<SoundCue> SoundManager::createSoundCue(
         const handy::StringId & aInterruptSoundId
         )
 {
-    std::size_t handleIndex = 0;
-    for (const auto & [handle, cue] : mCues)
-    {
-        if (cue == nullptr)
-        {
-            break;
-        }
-        handleIndex++;
-    }
-
-    std::unique_ptr<SoundCue> soundCue = std::make_unique<SoundCue>(
-            mCurrentCueId++,
-            handleIndex,
-            aCategory,
-            aPriority
-            );
+    SoundCue soundCue{aCategory, aPriority};
     int channels = 0;
 
     for (auto [soundId, option] : aSoundList)
     {
-        std::shared_ptr<OggSoundData> soundData = mLoadedSounds.at(soundId);
-        if (channels == 0 || channels == soundData->vorbisInfo.channels)
+        std::shared_ptr<OggSoundData> soundData = getSoundData(soundId);
+        if (soundData == nullptr)
+        {
+            spdlog::get("sounds")->error("Cannot add {} to a cue, it is not loaded", handy::revertStringId(soundId));
+        }
+        else if (channels == 0 || channels == soundData->vorbisInfo.channels)
         {
             channels = soundData->vorbisInfo.channels;
 
-            soundCue->sounds.push_back({soundData, option});
+            soundCue.sounds.push_back({soundId, option});
         }
         else
         {
@@ -602,10 +2701,14 @@ Handle<SoundCue> SoundManager::createSoundCue(
 
     if (aInterruptSoundId != handy::StringId::Null())
     {
-        std::shared_ptr<OggSoundData> interruptSoundData = mLoadedSounds.at(aInterruptSoundId);
-        if (channels == 0 || channels == interruptSoundData->vorbisInfo.channels)
+        std::shared_ptr<OggSoundData> interruptSoundData = getSoundData(aInterruptSoundId);
+        if (interruptSoundData == nullptr)
+        {
+            spdlog::get("sounds")->error("Cannot add {} to a cue, it is not loaded", handy::revertStringId(aInterruptSoundId));
+        }
+        else if (channels == 0 || channels == interruptSoundData->vorbisInfo.channels)
         {
-            soundCue->interruptSound = interruptSoundData;
+            soundCue.interruptSound = aInterruptSoundId;
         }
         else
         {
@@ -613,154 +2716,478 @@ Handle<SoundCue> SoundManager::createSoundCue(
         }
     }
 
-    Handle<SoundCue> handle{soundCue};
-    mCues.insert_or_assign(handle, std::move(soundCue));
+    Handle<SoundCue> handle = mCues.insert(std::move(soundCue));
     mPlayingCuesByCue.insert_or_assign(handle, std::vector<Handle<PlayingSoundCue>>{});
 
     return handle;
 }
 
+bool SoundManager::destroySoundCue(const Handle<SoundCue> & aHandle)
+{
+    if (!mCues.erase(aHandle))
+    {
+        return false;
+    }
+
+    mPlayingCuesByCue.erase(aHandle);
+    return true;
+}
+
 Handle<PlayingSoundCue> SoundManager::playSound(const Handle<SoundCue> & aHandle)
 {
-    SoundCue & soundCue = *mCues.at(aHandle);
+    return playCue(aHandle, SoundOption{}, false);
+}
+
+Handle<PlayingSoundCue> SoundManager::playSound(const Handle<SoundCue> & aHandle, const SoundOption & aOption)
+{
+    return playCue(aHandle, aOption, true);
+}
+
+//Picks the quietest voice around aOption.position when the limit is reached and the new voice is louder
+//Nothing is stopped here, playCue stops it once the new voice is sure to play
+bool SoundManager::limitVoicesAround(
+        const SoundOption & aOption,
+        SoundCategory aCategory,
+        const Handle<PlayingSoundCue> & aStoppedVoice,
+        Handle<PlayingSoundCue> & aStolenVoice)
+{
+    std::size_t count = 0;
+    Handle<PlayingSoundCue> quietest;
+    float quietestAudibility = std::numeric_limits<float>::infinity();
+    aStolenVoice = Handle<PlayingSoundCue>();
+
+    mVoiceGrid.forEachAround(aOption.position, [&](const Handle<PlayingSoundCue> & aVoiceHandle)
+    {
+        //The grid still holds the voices stopped since it was built
+        const PlayingSoundCue * cue = findPlayingCue(aVoiceHandle);
+        if (cue == nullptr || mVoices.states[cue->voice] != VoiceState_PLAYING || aVoiceHandle == aStoppedVoice)
+        {
+            return;
+        }
+
+        count++;
+        if (mVoices.audibilities[cue->voice] < quietestAudibility)
+        {
+            quietestAudibility = mVoices.audibilities[cue->voice];
+            quietest = aVoiceHandle;
+        }
+    });
+
+    if (count < mMaxVoicesPerRadius)
+    {
+        return true;
+    }
+
+    const float audibility = aOption.gain * getCategoryGain(aCategory) * getDistanceAttenuation(aOption.position);
+    if (quietestAudibility >= audibility)
+    {
+        return false;
+    }
+
+    aStolenVoice = quietest;
+    return true;
+}
+
+Handle<PlayingSoundCue> SoundManager::playCue(const Handle<SoundCue> & aHandle, const SoundOption & aOption, bool aPlaced)
+{
+    SoundCue * cue = mCues.find(aHandle);
+    if (cue == nullptr)
+    {
+        spdlog::get("sounds")->error("Cannot play a destroyed cue");
+        return Handle<PlayingSoundCue>();
+    }
+
+    SoundCue & soundCue = *cue;
 
     PlayingSoundCueQueue & priorityQueue = mCuesByCategories.at(soundCue.category);
 
     std::vector<Handle<PlayingSoundCue>> & alreadyPlayingCue = mPlayingCuesByCue.at(aHandle);
+    //Forget the playbacks of the cue that are over
+    std::erase_if(alreadyPlayingCue, [](const Handle<PlayingSoundCue> & aPlayingHandle)
+    {
+        return aPlayingHandle.toObject() == nullptr;
+    });
 
+    //The quietest playback of the cue is only stopped once nothing can refuse the new one
+    Handle<PlayingSoundCue> stolenPlayback;
     if (alreadyPlayingCue.size() == MAX_SOURCE_PER_CUE)
     {
-        spdlog::get("sounds")->trace("Not playing because too much already");
-        return Handle<PlayingSoundCue>();
+        const auto quietest = std::min_element(alreadyPlayingCue.begin(), alreadyPlayingCue.end(),
+                [this](const Handle<PlayingSoundCue> & aLhs, const Handle<PlayingSoundCue> & aRhs)
+                {
+                    return mVoices.audibilities[aLhs.toObject()->voice]
+                        < mVoices.audibilities[aRhs.toObject()->voice];
+                });
+
+        const float audibility =
+            aOption.gain * getCategoryGain(soundCue.category) * getDistanceAttenuation(aOption.position);
+        if (mVoices.audibilities[quietest->toObject()->voice] >= audibility)
+        {
+            spdlog::get("sounds")->trace("Not playing because too much already");
+            return Handle<PlayingSoundCue>();
+        }
 
-        //TODO(franz): here we should try to remove the less loud sound including the new
+        stolenPlayback = *quietest;
     }
 
-    if (mFreeSources.size() == 0) [[unlikely]]
+    //Evicted sounds are loaded again in the background, the playback waits for them as a virtual voice
+    std::vector<std::pair<std::shared_ptr<OggSoundData>, CueElementOption>> sounds;
+    for (const auto & [soundId, option] : soundCue.sounds)
     {
-        if(!priorityQueue.empty())
-        {
-            std::pop_heap(priorityQueue.begin(), priorityQueue.end(), CmpHandlePriority);
-            Handle<PlayingSoundCue> lessPriorizedHandle = priorityQueue.back();
+        sounds.push_back({requestSoundData(soundId), option});
+        markPlayed(soundId);
+    }
 
-            PlayingSoundCue * lessPriorizedCue = lessPriorizedHandle.toObject();
+    std::shared_ptr<OggSoundData> interruptSoundData = nullptr;
+    if (soundCue.interruptSound != handy::StringId::Null())
+    {
+        interruptSoundData = requestSoundData(soundCue.interruptSound);
+        markPlayed(soundCue.interruptSound);
+    }
 
-            if (lessPriorizedCue->priority <= soundCue.priority)
-            {
-                return Handle<PlayingSoundCue>();
-            }
+    const bool interruptSoundLoading =
+        soundCue.interruptSound != handy::StringId::Null() && interruptSoundData == nullptr;
+    bool loading = interruptSoundLoading;
+    for (const auto & [soundData, option] : sounds)
+    {
+        loading = loading || soundData == nullptr;
+    }
 
-            if (lessPriorizedHandle.mHandleIndex >= 0)
-            {
-                stopSound(lessPriorizedHandle);
-            }
+    //Sounds missing without being loaded were unloaded, the cue cannot play anymore
+    const bool unloaded = std::any_of(soundCue.sounds.begin(), soundCue.sounds.end(), [this](const auto & aSound)
+    {
+        return !mLoadedSounds.contains(aSound.first) && !mPendingLoads.contains(aSound.first);
+    }) || (interruptSoundLoading && !mPendingLoads.contains(soundCue.interruptSound));
+
+    if (unloaded)
+    {
+        spdlog::get("sounds")->error("Cannot play a cue using an unloaded sound");
+        return Handle<PlayingSoundCue>();
+    }
+
+    //The stolen playback frees its voice, otherwise the least important playback
+    //of the category gives its voice to a more important one
+    const std::size_t stolenVoices = stolenPlayback != Handle<PlayingSoundCue>() ? 1 : 0;
+    if (mVoices.size() - stolenVoices >= mMaxVoices)
+    {
+        if (stolenVoices == 0 && !priorityQueue.empty() && priorityQueue.top().priority > soundCue.priority)
+        {
+            stolenPlayback = priorityQueue.top().handle;
         }
         else
         {
+            spdlog::get("sounds")->warn("Not playing, {} voices are already playing", mVoices.size());
             return Handle<PlayingSoundCue>();
         }
+    }
+
+    Handle<PlayingSoundCue> stolenNeighbour;
+    if (aPlaced && mVoiceLimitRadius > 0.f
+            && !limitVoicesAround(aOption, soundCue.category, stolenPlayback, stolenNeighbour))
+    {
+        spdlog::get("sounds")->trace("Not playing because too many louder voices around");
+        return Handle<PlayingSoundCue>();
+    }
 
+    //Nothing can refuse the play anymore
+    if (stolenPlayback != Handle<PlayingSoundCue>())
+    {
+        stopSound(stolenPlayback);
+        //Does nothing when the playback belongs to another cue of the category
+        std::erase(alreadyPlayingCue, stolenPlayback);
+    }
+    if (stolenNeighbour != Handle<PlayingSoundCue>())
+    {
+        stopSound(stolenNeighbour);
     }
 
-    std::size_t sourceIndex = mFreeSources.back();
-    mFreeSources.pop_back();
-    ALuint source = mSources.at(sourceIndex);
+    std::shared_ptr<PlayingSoundCue> playingCue = std::make_shared<PlayingSoundCue>(
+            soundCue, sounds, interruptSoundData);
+    if (interruptSoundLoading)
+    {
+        //Its sound is set once loaded
+        playingCue->interruptSound.emplace(nullptr, CueElementOption{});
+    }
+    Handle<PlayingSoundCue> handle = mPlayingCues.insert(playingCue);
+    const std::size_t voice = mVoices.add(
+            handle,
+            *playingCue,
+            loading ? std::numeric_limits<float>::infinity() : getCueDuration(*playingCue));
+    if (loading)
+    {
+        spdlog::get("sounds")->info("Waiting for the sounds of the cue to be loaded before playing it");
+        mVoices.loading[voice] = true;
+        mLoadingPlaybacks.push_back({handle, soundCue.sounds, soundCue.interruptSound});
+    }
+    mVoices.setOption(voice, aOption);
+    mVoices.audibilities[voice] = getVoiceGain(voice) * getDistanceAttenuation(aOption.position);
 
-    std::size_t handleIndex = 0;
-    for (auto & [handle, cue] : mPlayingCues)
+    //Counts toward the limit of the sounds played in the same update
+    if (aPlaced && mVoiceLimitRadius > 0.f)
     {
-        if (cue == nullptr)
+        mVoiceGrid.insert(aOption.position, handle);
+    }
+
+    //Without a free source, or too quiet to be heard, the voice starts virtual
+    //and update() promotes it if it is important enough, like assignSources would
+    std::vector<std::size_t> & freeSources = getFreeSources(playingCue->stereo);
+    if (!loading && mVoices.audibilities[voice] >= mInaudibleGain && !freeSources.empty())
+    {
+        const std::size_t sourceIndex = freeSources.back();
+        freeSources.pop_back();
+        promoteVoice(voice, sourceIndex);
+    }
+
+    priorityQueue.push(handle, playingCue->priority);
+
+    alreadyPlayingCue.push_back(handle);
+
+    return handle;
+}
+
+//A compressed resident sound has no decoded samples to start with,
+//a first short chunk is asked to the decoder pool so it is delivered quickly.
+//Its source is started by feedCue once the chunk is queued
+void SoundManager::primeStreamedSound(const PlayingSound & aSound)
+{
+    if (aSound.stream != nullptr
+            && aSound.soundData->compressedResident
+            && aSound.positionInData >= aSound.stream->lengthDecoded)
+    {
+        requestDecode(aSound, MINIMUM_SAMPLE_BUFFERED_ON_CREATION);
+    }
+}
+
+//Makes sure the decoded ring of a streamed sound is going to hold its next samples
+//Positions count interleaved samples, the look-ahead is per channel
+void SoundManager::prepareStreamedSound(const PlayingSound & aSound)
+{
+    if (aSound.stream != nullptr
+            && aSound.stream->lengthDecoded
+                < aSound.positionInData
+                    + static_cast<std::size_t>(DECODE_AHEAD_SAMPLE) * aSound.soundData->vorbisInfo.channels
+            && !aSound.stream->fullyDecoded)
+    {
+        requestDecode(aSound, MINIMUM_SAMPLE_EXTRACTED);
+    }
+}
+
+bool SoundManager::startCue(PlayingSoundCue & aCue, ALuint aSource, float aCursor, bool aInterrupted)
+{
+    aCue.source = aSource;
+
+    //A cue promoted again restarts from the cursor of its voice
+    for (PlayingSound & sound : aCue.sounds)
+    {
+        rewindPlayingSound(sound);
+    }
+    if (aCue.interruptSound.has_value())
+    {
+        rewindPlayingSound(*aCue.interruptSound);
+    }
+
+    PlayingSound * sound = nullptr;
+    std::size_t sampleOffset = 0;
+
+    if (aInterrupted)
+    {
+        aCue.state = PlayingSoundCueState_INTERRUPTED;
+        if (seekPlayingSound(*aCue.interruptSound, aCursor, sampleOffset))
+        {
+            sound = &*aCue.interruptSound;
+        }
+    }
+    else
+    {
+        aCue.state = PlayingSoundCueState_PLAYING;
+        for (std::size_t i = 0; i < aCue.sounds.size() && sound == nullptr; i++)
         {
-            break;
+            aCue.currentPlayingSoundIndex = i;
+            aCue.currentWaitingForBufferSoundIndex = i;
+            if (seekPlayingSound(aCue.sounds[i], aCursor, sampleOffset))
+            {
+                sound = &aCue.sounds[i];
+            }
         }
-        handleIndex++;
     }
 
-    std::unique_ptr<PlayingSoundCue> playingCue = std::make_unique<PlayingSoundCue>(soundCue, source, mCurrentCueId++, handleIndex);
+    if (sound == nullptr)
+    {
+        aCue.state = PlayingSoundCueState_NOT_PLAYING;
+        return false;
+    }
+
+    aCue.paused = false;
+    aCue.acquireBuffers(mBufferPool);
+    primeStreamedSound(*sound);
+    prepareStreamedSound(*sound);
 
-    std::shared_ptr<PlayingSound> sound = playingCue->sounds[playingCue->currentPlayingSoundIndex];
-    std::shared_ptr<OggSoundData> data = sound->soundData;
+    sound->state = PlayingSoundState_PLAYING;
+    bufferPlayingSound(*sound);
 
-    if (data->lengthDecoded < sound->positionInData + MINIMUM_SAMPLE_BUFFERED_ON_CREATION && !data->fullyDecoded)
+    //A stream still waiting on the decoder pool is started by feedCue once its first samples are queued
+    if (sound->stagedBuffers.empty())
     {
-        decodeSoundData(data, MINIMUM_SAMPLE_BUFFERED_ON_CREATION);
+        aCue.publishSnapshot();
+        return true;
     }
 
-    playingCue->state = PlayingSoundCueState_PLAYING;
-    sound->state = PlayingSoundState_PLAYING;
-    bufferPlayingSound(sound);
-    alCall(alSourceQueueBuffers, playingCue->source, sound->stagedBuffers.size(), sound->stagedBuffers.data());
+    alCall(alSourceQueueBuffers, aSource, sound->stagedBuffers.size(), sound->stagedBuffers.data());
 
     //empty staged buffers
     sound->stagedBuffers.resize(0);
 
-    alCall(alSourcePlay, playingCue->source);
+    //Other sounds resume from positionInData
+    if (sound->usesStaticBuffer() && sampleOffset > 0)
+    {
+        alCall(alSourcei, aSource, AL_SAMPLE_OFFSET, static_cast<ALint>(sampleOffset));
+    }
+
+    alCall(alSourcePlay, aSource);
+    aCue.publishSnapshot();
+    return true;
+}
 
-    Handle<PlayingSoundCue> handle{playingCue};
-    mPlayingCues.insert_or_assign(handle, std::move(playingCue));
+void PlayingSoundCue::publishSnapshot()
+{
+    //Only the debug ui reads snapshots, feeding does not pay for them otherwise
+    if (!snapshotRequested.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    snapshotRequested.store(false, std::memory_order_relaxed);
 
-    priorityQueue.push_back(handle);
-    std::push_heap(priorityQueue.begin(), priorityQueue.end(), CmpHandlePriority);
+    std::scoped_lock lock{snapshotMutex};
+    //The waiting index moves past the last sound once the cue is finished
+    const bool interrupted = state == PlayingSoundCueState_INTERRUPTED;
+    if (interrupted || currentPlayingSoundIndex < sounds.size())
+    {
+        snapshot.playingSoundId = getPlayingSound().soundData->soundId;
+    }
+    if (interrupted || currentWaitingForBufferSoundIndex < sounds.size())
+    {
+        snapshot.waitingSoundId = getWaitingSound().soundData->soundId;
+    }
+    snapshot.sounds.resize(sounds.size());
 
-    alreadyPlayingCue.push_back(handle);
+    for (std::size_t i = 0; i < sounds.size(); i++)
+    {
+        const PlayingSound & sound = sounds[i];
+        PlayingSoundSnapshot & soundSnapshot = snapshot.sounds[i];
+        soundSnapshot.soundId = sound.soundData->soundId;
+        soundSnapshot.loops = sound.loops;
+        soundSnapshot.bufferCount = sound.buffers.size();
+        soundSnapshot.stagedBufferCount = sound.stagedBuffers.size();
+        soundSnapshot.freeBufferCount = sound.freeBuffers.size();
+        soundSnapshot.positionInData = sound.positionInData;
+        soundSnapshot.streamed = sound.stream != nullptr;
+
+        if (sound.stream != nullptr)
+        {
+            const OggStream & stream = *sound.stream;
+            //The decoder side belongs to the decoding job while it is pending
+            if (!stream.decodePending)
+            {
+                soundSnapshot.streamUsedData = stream.usedData;
+            }
+            soundSnapshot.ringStart = stream.decodedRing.getStart();
+            soundSnapshot.ringEnd = stream.decodedRing.getEnd();
+            soundSnapshot.ringCapacity = stream.decodedRing.getCapacity();
+            soundSnapshot.fullyDecoded = stream.fullyDecoded;
+        }
+    }
+}
 
-    return handle;
+PlayingSoundCueSnapshot PlayingSoundCue::getSnapshot() const
+{
+    snapshotRequested.store(true, std::memory_order_relaxed);
+    std::scoped_lock lock{snapshotMutex};
+    return snapshot;
 }
 
-void bufferPlayingSound(const std::shared_ptr<PlayingSound> & aSound)
+void bufferPlayingSound(PlayingSound & aSound)
 {
-    std::list<ALuint> & freeBuffers = aSound->freeBuffers;
-    std::shared_ptr<OggSoundData> data = aSound->soundData;
+    std::vector<ALuint> & freeBuffers = aSound.freeBuffers;
+    const std::shared_ptr<OggSoundData> & data = aSound.soundData;
 
     if (freeBuffers.size() > 0)
     {
-        auto bufIt = freeBuffers.begin();
-        ALuint freeBuf = *bufIt;
-
-        std::size_t nextPositionInData = 0;
+        ALuint freeBuf = freeBuffers.back();
+        const std::size_t lengthDecoded = aSound.getLengthDecoded();
+        const bool fullyDecoded = aSound.isFullyDecoded();
+        std::size_t nextPositionInData = lengthDecoded;
 
-        if (data->streamedData)
+        //The static buffer already holds the whole sound, a pass only queues it
+        if (!aSound.usesStaticBuffer())
         {
-            nextPositionInData = std::min(
-                    static_cast<std::size_t>(data->lengthDecoded),
-                    aSound->positionInData + static_cast<std::size_t>(MINIMUM_SAMPLE_EXTRACTED) * data->vorbisInfo.channels
+            //Bytes of the next samples in the format of the sound
+            std::span<const std::byte> samples;
+            const std::size_t sampleSize = getSampleSize(data->sampleFormat);
+            const std::size_t maxSamples = data->streamedData ?
+                static_cast<std::size_t>(MINIMUM_SAMPLE_EXTRACTED) * data->vorbisInfo.channels
+                : data->lengthDecoded;
+
+            if (aSound.positionInData < data->lengthDecoded)
+            {
+                samples = {
+                    data->getDecodedSamples().data() + aSound.positionInData * sampleSize,
+                    std::min(maxSamples, data->lengthDecoded - aSound.positionInData) * sampleSize
+                };
+            }
+            else if (aSound.stream != nullptr)
+            {
+                samples = aSound.stream->decodedRing.getContiguous(
+                        aSound.positionInData * sampleSize, maxSamples * sampleSize);
+            }
+
+            nextPositionInData = aSound.positionInData + samples.size() / sampleSize;
+
+            if (samples.empty() && !(fullyDecoded && aSound.positionInData == lengthDecoded))
+            {
+                //Decoder pool has not delivered the next chunk yet
+                return;
+            }
+
+            spdlog::get("sounds")->info(
+                    "buffer: {}, from: {}, size: {}",
+                    freeBuf,
+                    aSound.positionInData,
+                    nextPositionInData - aSound.positionInData
                     );
-        }
-        else
-        {
-            nextPositionInData = data->lengthDecoded;
-        }
 
-        spdlog::get("sounds")->info(
-                "buffer: {}, from: {}, size: {}",
-                freeBuf,
-                aSound->positionInData,
-                nextPositionInData - aSound->positionInData
-                );
+            alCall(
+                    alBufferData,
+                    freeBuf,
+                    data->dataFormat,
+                    samples.data(),
+                    samples.size(),
+                    data->vorbisInfo.sample_rate
+                    );
 
-        alCall(
-                alBufferData,
-                freeBuf,
-                SOUNDS_AL_FORMAT[data->vorbisInfo.channels],
-                data->decodedData.data() + aSound->positionInData,
-                sizeof(float) * (nextPositionInData - aSound->positionInData),
-                data->vorbisInfo.sample_rate
-                );
+            if (aSound.stream != nullptr)
+            {
+                aSound.stream->decodedRing.consume(nextPositionInData * sampleSize);
+            }
+        }
 
-        aSound->positionInData = nextPositionInData;
-        bufIt = freeBuffers.erase(bufIt);
-        aSound->stagedBuffers.push_back(freeBuf);
+        aSound.positionInData = nextPositionInData;
+        freeBuffers.pop_back();
+        aSound.stagedBuffers.push_back(freeBuf);
 
-        if (nextPositionInData == data->lengthDecoded && data->fullyDecoded)
+        if (nextPositionInData == lengthDecoded && fullyDecoded)
         {
-            if (aSound->loops == 0)
+            if (aSound.loops == 0)
             {
-                aSound->state = PlayingSoundState_STALE;
+                aSound.state = PlayingSoundState_STALE;
             }
             else
             {
-                aSound->loops--;
-                aSound->positionInData = 0;
+                aSound.loops--;
+                aSound.positionInData = 0;
+                if (aSound.stream != nullptr)
+                {
+                    rewindStream(*aSound.stream, *data);
+                }
             }
         }
     }
@@ -768,28 +3195,63 @@ void bufferPlayingSound(const std::shared_ptr<PlayingSound> & aSound)
 
 void SoundManager::updateCue(PlayingSoundCue & currentCue, const Handle<PlayingSoundCue> & aHandle)
 {
-    std::shared_ptr<PlayingSound> sound = currentCue.getWaitingSound();
+    applyVoiceOption(currentCue.voice);
+
+    //A cue promoted past its end never started
+    if (currentCue.state == PlayingSoundCueState_NOT_PLAYING || feedCue(currentCue))
+    {
+        stopSound(aHandle);
+    }
+}
+
+SoundOption SoundManager::getSourceOption(std::size_t aVoice) const
+{
+    SoundOption option = mVoices.getOption(aVoice);
+    option.gain = getVoiceGain(aVoice);
+    return option;
+}
+
+void SoundManager::applyVoiceOption(std::size_t aVoice)
+{
+    if (!mVoices.optionsChanged[aVoice])
+    {
+        return;
+    }
+
+    //The feeder thread makes every openAL call on the sources it feeds.
+    //Only the latest option of the voice matters, so it is not queued behind waiting commands,
+    //which could hold the PLAY command it has to follow
+    if (mThreadedFeeding)
+    {
+        const Handle<PlayingSoundCue> & handle = mVoices.handles[aVoice];
+        if (!mOverflowFeederCommands.empty()
+                || !mFeederCommands.push({
+                    .type = FeederCommandType_OPTION,
+                    .handle = handle,
+                    .cue = *mPlayingCues.find(handle),
+                    .option = getSourceOption(aVoice)}))
+        {
+            return;
+        }
+    }
+    else
+    {
+        applySourceOption(mVoices.sources[aVoice], getSourceOption(aVoice));
+    }
+
+    mVoices.optionsChanged[aVoice] = false;
+}
+
+bool SoundManager::feedCue(PlayingSoundCue & currentCue)
+{
+    PlayingSound * sound = &currentCue.getWaitingSound();
 
     const ALuint source = currentCue.source;
 
     int bufferProcessed = 0;
     alCall(alGetSourceiv, source, AL_BUFFERS_PROCESSED, &bufferProcessed);
 
-    std::list<ALuint> & freeBuffers = sound->freeBuffers;
-
-    //updating position and velocity
-    const SoundOption option = currentCue.option;
-    alCall(alSource3f, source, AL_POSITION, option.position.x(), option.position.y(), option.position.z());
-    alCall(alSource3f, source, AL_VELOCITY, option.velocity.x(), option.velocity.y(), option.velocity.z());
-
-    const CategoryOption catOption = mCategoryOptions.at(currentCue.category);
-    const CategoryOption masterOption = mCategoryOptions.at(MASTER_SOUND_CATEGORY);
-    alCall(
-            alSourcef,
-            source,
-            AL_GAIN,
-            option.gain * catOption.userGain * catOption.gameGain * masterOption.userGain * masterOption.gameGain
-            );
+    std::vector<ALuint> & freeBuffers = sound->freeBuffers;
 
     //add used buffer to freeBuffers list
     if (bufferProcessed > 0)
@@ -804,7 +3266,7 @@ void SoundManager::updateCue(PlayingSoundCue & currentCue, const Handle<PlayingS
             currentCue.currentWaitingForBufferSoundIndex++;
             if (currentCue.currentWaitingForBufferSoundIndex < currentCue.sounds.size())
             {
-                sound = currentCue.getWaitingSound();
+                sound = &currentCue.getWaitingSound();
             }
         }
     }
@@ -812,14 +3274,13 @@ void SoundManager::updateCue(PlayingSoundCue & currentCue, const Handle<PlayingS
     if (sound->state == PlayingSoundState_FINISHED)
     {
         currentCue.state = PlayingSoundCueState_NOT_PLAYING;
-
-        stopSound(aHandle);
-        return;
+        currentCue.publishSnapshot();
+        return true;
     }
 
     if (currentCue.state == PlayingSoundCueState_PLAYING)
     {
-        sound = currentCue.getPlayingSound();
+        sound = &currentCue.getPlayingSound();
 
         if (sound->state == PlayingSoundState_STALE)
         {
@@ -829,41 +3290,58 @@ void SoundManager::updateCue(PlayingSoundCue & currentCue, const Handle<PlayingS
             }
             else
             {
-                sound = currentCue.sounds[++currentCue.currentPlayingSoundIndex];
+                sound = &currentCue.sounds[++currentCue.currentPlayingSoundIndex];
                 sound->state = PlayingSoundState_PLAYING;
             }
         }
+    }
+    else if (currentCue.state == PlayingSoundCueState_INTERRUPTED)
+    {
+        //The interrupt sound is fed like any other until it is stale
+        sound = &*currentCue.interruptSound;
+    }
 
+    if (currentCue.state == PlayingSoundCueState_PLAYING
+            || currentCue.state == PlayingSoundCueState_INTERRUPTED)
+    {
+        prepareStreamedSound(*sound);
 
-        std::shared_ptr<OggSoundData> data = sound->soundData;
+        if (sound->state == PlayingSoundState_PLAYING)
+        {
+            bufferPlayingSound(*sound);
+        }
 
-        if (currentCue.state == PlayingSoundCueState_PLAYING)
+        if (sound->stagedBuffers.size() > 0)
         {
-            if (data->lengthDecoded < sound->positionInData + MINIMUM_SAMPLE_EXTRACTED && !data->fullyDecoded)
-            {
-                decodeSoundData(data);
-            }
+            alCall(alSourceQueueBuffers, currentCue.source, sound->stagedBuffers.size(), sound->stagedBuffers.data());
 
-            if (sound->state == PlayingSoundState_PLAYING)
+            //The source ran dry while waiting on the decoder pool, or never started.
+            //Pausing a stopped source does nothing, so a paused cue stays stopped until started again
+            const ALint sourceState = getSourceState(source);
+            if ((sourceState == AL_STOPPED || sourceState == AL_INITIAL) && !currentCue.paused)
             {
-                bufferPlayingSound(sound);
+                alCall(alSourcePlay, source);
             }
-
-            alCall(alSourceQueueBuffers, currentCue.source, sound->stagedBuffers.size(), sound->stagedBuffers.data());
-
-            //empty staged buffers
-            sound->stagedBuffers.resize(0);
         }
+
+        //empty staged buffers
+        sound->stagedBuffers.resize(0);
     }
+
+    currentCue.publishSnapshot();
+    return false;
 }
 
 const SoundManagerInfo SoundManager::getInfo() const
 {
     return {
         mPlayingCues,
+        mVoices,
         mSources,
-        mFreeSources,
+        mMonoSourceCount,
+        mSourceOwners,
         mLoadedSounds,
+        mBufferPool,
     };
 }
 
@@ -1,6 +1,15 @@
 #pragma once
 
+#include "BufferPool.h"
+#include "CommandQueue.h"
+#include "DecoderPool.h"
+#include "PriorityHeap.h"
+#include "RingBuffer.h"
+#include "SampleFormat.h"
+#include "SlotMap.h"
+#include "SoundBank.h"
 #include "SoundUtilities.h"
+#include "SpatialGrid.h"
 
 #define STB_VORBIS_NO_STDIO
 #define STB_VORBIS_NO_INTEGER_CONVERSION
@@ -18,11 +27,19 @@
 #include <AL/alc.h>
 #include <AL/alext.h>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <queue>
+#include <span>
 #include <string>
+#include <thread>
 #include <vector>
 #include <list>
 
@@ -33,14 +50,9 @@ namespace sounds {
 
 /*
  * Ideas :
- * - Max sources per radius (2 is a good number)
  * - better ducking (like playWithDucking to lower all sound for the duration of the sound)
- * - Removing source that are basically inaudible
  * - Start sound paused to avoid sound playing before being placed
- * - Find a way to manage memory consumption
- * - Threaded decoding
  * - Threaded mixing
- * - Threaded feeding to openal
  * - Display position in debug ui
  */
 
@@ -70,13 +82,18 @@ typedef int SoundCategory;
 constexpr int MASTER_SOUND_CATEGORY = -1;
 constexpr int HIGHEST_PRIORITY = -1;
 constexpr int BUFFER_PER_CHANNEL = 5;
-constexpr std::size_t MAX_SOURCES = 5;
+//Passes of a sound held in a static buffer queued at once, so a loop does not wait on update()
+constexpr std::size_t STATIC_BUFFER_QUEUED_PASSES = 2;
+//Source of a virtual voice
+constexpr ALuint NO_SOURCE = 0;
 const std::size_t MAX_SOURCE_PER_CUE = 3;
+constexpr std::size_t FEEDER_QUEUE_SIZE = 256;
 
 template<typename T>
 inline std::vector<T> interleave(T * left, T * right, int size)
 {
-    std::vector<float> result(size);
+    std::vector<T> result;
+    result.reserve(2 * static_cast<std::size_t>(size));
 
     for (std::size_t i = 0; i < static_cast<std::size_t>(size); i++)
     {
@@ -87,28 +104,102 @@ inline std::vector<T> interleave(T * left, T * right, int size)
     return result;
 }
 
+//Immutable once published by the manager, shared by every playback of the sound
+//A streamed sound only keeps its compressed source and its first decoded samples,
+//each playback decodes the rest with its own OggStream.
+//A compressed resident sound keeps no decoded samples at all, each playback decodes it from the start.
 struct OggSoundData
 {
-    handy::StringId soundId;
-
-    std::shared_ptr<std::istream> dataStream;
+    handy::StringId soundId = handy::StringId::Null();
+
+    //Opens a new stream at the start of the compressed data of a streamed sound
+    std::function<std::unique_ptr<std::istream>()> openStream{};
+    //Header bytes opening the decoder of each playback
+    std::vector<char> headerData{};
+    //Compressed data of a streamed sound held in memory, each playback decodes it in place
+    //Empty when each playback reads its own stream
+    std::span<const char> compressedData{};
+    //Keeps compressedData alive, a file mapping or a buffer
+    std::shared_ptr<const void> compressedDataOwner{};
     std::streamsize usedData = 0;
-    std::vector<char> undecodedReadData;
+    //Compressed bytes read while loading
     std::size_t lengthRead = 0;
-    bool fullyRead;
 
-    ResourceGuard<stb_vorbis *> vorbisData;
-    stb_vorbis_info vorbisInfo;
+    stb_vorbis_info vorbisInfo{};
+    //Samples per channel of the whole sound, 0 if it is not known when loading
+    std::size_t lengthInSamples = 0;
     std::size_t lengthDecoded = 0;
-    bool fullyDecoded;
-    ALenum dataFormat;
+    bool fullyDecoded = false;
+    ALenum dataFormat = 0;
+    SampleFormat sampleFormat = SampleFormat_FLOAT32;
 
     bool streamedData = false;
+    //Short streamed sound held compressed in memory, decoded when a playback starts
+    bool compressedResident = false;
     bool cacheData = false;
 
-    unsigned int sampleRate;
+    unsigned int sampleRate = 0;
+
+    //Fully decoded data of non streamed sound, emptied once uploaded to staticBuffer
+    //First decoded samples of a streamed sound, played while its stream starts decoding
+    //Samples are stored in sampleFormat, lengthDecoded counts samples
+    std::vector<std::byte> decodedData{};
+    //Samples of a non streamed sound read in place from the pcm cache, decodedData is then empty
+    std::span<const std::byte> cachedData{};
+    //Keeps cachedData alive, the mapping of the cache entry
+    std::shared_ptr<const void> cachedDataOwner{};
+    //Samples of a non streamed sound uploaded when the sound is published
+    //Playbacks queue it instead of uploading the samples each time
+    StaticBuffer staticBuffer{};
+
+    std::span<const std::byte> getDecodedSamples() const
+    { return cachedDataOwner != nullptr ? cachedData : std::span<const std::byte>{decodedData}; }
+};
+
+//Loads a sound again from where it was first read, from any thread
+using SoundLoader = std::function<std::shared_ptr<OggSoundData>()>;
+
+//Decoding state of one playback of a streamed sound.
+//The decoder side is only touched by the decoding job while decodePending is set,
+//the ring side only by the thread calling SoundManager::update() (or the feeder thread).
+struct OggStream
+{
+    OggStream(const OggSoundData & aSoundData);
+
+    //Decoder side, opened by the first decoding job
+    std::unique_ptr<std::istream> dataStream;
+    ResourceGuard<stb_vorbis *> vorbisData;
+    //Absolute position in the stream of the first byte not decoded yet
+    std::size_t usedData = 0;
+    std::vector<char> undecodedReadData;
+    //Absolute position in the stream of the first byte of undecodedReadData
+    std::size_t undecodedOffset = 0;
+    std::size_t lengthRead = 0;
+    bool fullyRead = false;
+    //Absolute position of the next sample out of the decoder
+    std::size_t decoderPosition = 0;
+
+    //Ring side, samples before startPosition are never pushed
+    //The ring holds bytes of samples in the format of the sound, its positions are in bytes
+    std::size_t sampleSize;
+    //End of OggSoundData::decodedData, or where a resumed playback starts past it
+    std::size_t startPosition;
+    RingBuffer<std::byte> decodedRing;
+    std::size_t lengthDecoded = 0;
+    bool fullyDecoded = false;
+    bool decodePending = false;
+    //Next decoding job reopens the decoder at the start of the stream
+    bool restartDecoder = true;
+    //Pending decoding job belongs to a previous pass on the stream
+    bool discardPendingChunk = false;
+};
 
-    std::vector<float> decodedData;
+//Result of a decoding job, handed back to the game thread
+struct DecodedChunk
+{
+    std::shared_ptr<OggStream> stream{};
+    std::vector<std::byte> decodedData{};
+    bool fullyDecoded = false;
 };
 
 struct CueElementOption
@@ -135,26 +226,36 @@ struct PlayingSound
     // 3 buffers: processed buffer, queued buffer and playing buffer
     PlayingSound(const std::shared_ptr<OggSoundData> & aSoundData, const CueElementOption & option):
         soundData{aSoundData},
+        loopCount{option.loops},
         loops{option.loops}
     {
-        if (aSoundData != nullptr)
+        if (aSoundData != nullptr && aSoundData->streamedData && !aSoundData->fullyDecoded)
         {
-            buffers.resize(static_cast<std::size_t>(aSoundData->vorbisInfo.channels) * BUFFER_PER_CHANNEL);
-            alCall(alGenBuffers, aSoundData->vorbisInfo.channels * BUFFER_PER_CHANNEL, buffers.data());
-
-            for (auto buf : buffers)
-            {
-                freeBuffers.push_back(buf);
-            }
+            stream = std::make_shared<OggStream>(*aSoundData);
         }
     }
 
+    std::size_t getLengthDecoded() const
+    { return stream != nullptr ? stream->lengthDecoded : soundData->lengthDecoded; }
+
+    bool isFullyDecoded() const
+    { return stream != nullptr ? stream->fullyDecoded : soundData->fullyDecoded; }
+
+    bool usesStaticBuffer() const
+    { return soundData != nullptr && soundData->staticBuffer.isValid(); }
+
     std::shared_ptr<OggSoundData> soundData;
+    //Only for streamed sound that do not fit in their first decoded samples
+    std::shared_ptr<OggStream> stream;
     //Left is first 3 buffers Right is last 3 buffers
-    std::list<ALuint> freeBuffers;
+    //Borrowed from the BufferPool of the manager while the cue has a source
+    std::vector<ALuint> freeBuffers;
     std::vector<ALuint> stagedBuffers;
     std::vector<ALuint> buffers;
 
+    //Loops asked by the cue, never modified so any thread can read it
+    int loopCount;
+    //Loops left to play
     int loops;
 
 
@@ -162,127 +263,488 @@ struct PlayingSound
     PlayingSoundState state = PlayingSoundState_WAITING;
 };
 
+//Streaming state of a sound of a playing cue, copied for the debug ui
+struct PlayingSoundSnapshot
+{
+    handy::StringId soundId;
+    int loops = 0;
+    std::size_t bufferCount = 0;
+    std::size_t stagedBufferCount = 0;
+    std::size_t freeBufferCount = 0;
+    std::size_t positionInData = 0;
+    bool streamed = false;
+    //Bytes decoded by the stream, as of the last decoding job committed
+    std::size_t streamUsedData = 0;
+    std::size_t ringStart = 0;
+    std::size_t ringEnd = 0;
+    std::size_t ringCapacity = 0;
+    bool fullyDecoded = false;
+};
+
+struct PlayingSoundCueSnapshot
+{
+    handy::StringId playingSoundId;
+    handy::StringId waitingSoundId;
+    std::vector<PlayingSoundSnapshot> sounds;
+};
+
 struct SoundCue
 {
-    SoundCue(int aId, int aHandleIndex, SoundCategory aCategory, int aPriority) :
-        id{aId},
-        handleIndex{aHandleIndex},
+    SoundCue(SoundCategory aCategory, int aPriority) :
         category{aCategory},
         priority{aPriority}
     {}
 
-    int id;
-    int handleIndex;
     SoundCategory category;
     int priority;
-    std::vector<std::pair<std::shared_ptr<OggSoundData>, CueElementOption>> sounds;
-    std::shared_ptr<OggSoundData> interruptSound = nullptr;
+    //Sounds are looked up when the cue plays so a cue does not keep them loaded
+    std::vector<std::pair<handy::StringId, CueElementOption>> sounds;
+    handy::StringId interruptSound = handy::StringId::Null();
 };
 
+//Streaming state of a playback, owned by the feeder thread when feeding is threaded
+//Its source and options are in the PlayingVoices of the manager
 struct PlayingSoundCue
 {
     PlayingSoundCue(
             const SoundCue & aSoundCue,
-            ALuint source,
-            int aId,
-            int aHandleIndex
+            const std::vector<std::pair<std::shared_ptr<OggSoundData>, CueElementOption>> & aSounds,
+            const std::shared_ptr<OggSoundData> & aInterruptSound
             ) :
-        id{aId},
-        handleIndex{aHandleIndex},
         priority{aSoundCue.priority},
-        category{aSoundCue.category},
-        source{source}
+        category{aSoundCue.category}
     {
-        alCall(alSourcei, source, AL_SOURCE_RELATIVE, AL_TRUE);
-        for (const auto & [data, option] : aSoundCue.sounds)
+        sounds.reserve(aSounds.size());
+        for (const auto & [data, option] : aSounds)
         {
-            sounds.push_back(std::make_shared<PlayingSound>(data, option));
+            sounds.emplace_back(data, option);
+            //A sound still loading is set once loaded, before the cue gets a source
+            stereo = stereo || (data != nullptr && data->vorbisInfo.channels > 1);
         }
 
-        if (aSoundCue.interruptSound != nullptr)
+        if (aInterruptSound != nullptr)
         {
-            interruptSound = std::make_shared<PlayingSound>(aSoundCue.interruptSound, CueElementOption{});
+            interruptSound.emplace(aInterruptSound, CueElementOption{});
+            stereo = stereo || aInterruptSound->vorbisInfo.channels > 1;
         }
     }
 
-    std::shared_ptr<PlayingSound> getWaitingSound() const
+    PlayingSound & getWaitingSound()
     {
         if (state == PlayingSoundCueState_INTERRUPTED)
         {
-            return interruptSound;
+            return *interruptSound;
         }
 
         return sounds[currentWaitingForBufferSoundIndex];
     }
 
-    std::shared_ptr<PlayingSound> getPlayingSound() const
+    const PlayingSound & getWaitingSound() const
+    { return const_cast<PlayingSoundCue *>(this)->getWaitingSound(); }
+
+    PlayingSound & getPlayingSound()
     {
         if (state == PlayingSoundCueState_INTERRUPTED)
         {
-            return interruptSound;
+            return *interruptSound;
         }
 
-        std::shared_ptr<PlayingSound> sound = sounds[currentPlayingSoundIndex];
+        return sounds[currentPlayingSoundIndex];
+    }
+
+    const PlayingSound & getPlayingSound() const
+    { return const_cast<PlayingSoundCue *>(this)->getPlayingSound(); }
 
-        return sound;
+    //Takes the buffers of each sound when the cue gets a source
+    void acquireBuffers(BufferPool & aBufferPool)
+    {
+        for (PlayingSound & sound : sounds)
+        {
+            acquireSoundBuffers(sound, aBufferPool);
+        }
+
+        if (interruptSound.has_value())
+        {
+            acquireSoundBuffers(*interruptSound, aBufferPool);
+        }
     }
 
-    int id;
-    int handleIndex;
+    //Gives the buffers back once they are detached from the source
+    void releaseBuffers(BufferPool & aBufferPool)
+    {
+        for (PlayingSound & sound : sounds)
+        {
+            releaseSoundBuffers(sound, aBufferPool);
+        }
+
+        if (interruptSound.has_value())
+        {
+            releaseSoundBuffers(*interruptSound, aBufferPool);
+        }
+    }
+
+    static void acquireSoundBuffers(PlayingSound & aSound, BufferPool & aBufferPool)
+    {
+        if (!aSound.buffers.empty())
+        {
+            return;
+        }
+
+        if (aSound.usesStaticBuffer())
+        {
+            //Each pass of the sound queues the same buffer
+            aSound.buffers.assign(STATIC_BUFFER_QUEUED_PASSES, aSound.soundData->staticBuffer.get());
+        }
+        else
+        {
+            aSound.buffers = aBufferPool.acquire(
+                    static_cast<std::size_t>(aSound.soundData->vorbisInfo.channels) * BUFFER_PER_CHANNEL);
+        }
+        aSound.freeBuffers = aSound.buffers;
+    }
+
+    //Called by the thread feeding the cue once it is done changing its streaming state
+    //Only copies the streaming state when a snapshot was asked for since the last one
+    void publishSnapshot();
+    //Any thread can read the snapshot, never the streaming state itself.
+    //Asks for a new snapshot, it is published by the next feed of the cue
+    PlayingSoundCueSnapshot getSnapshot() const;
+
+    static void releaseSoundBuffers(PlayingSound & aSound, BufferPool & aBufferPool)
+    {
+        //A static buffer belongs to the sound data
+        if (!aSound.usesStaticBuffer())
+        {
+            aBufferPool.release(aSound.buffers);
+        }
+        aSound.buffers.clear();
+        aSound.freeBuffers.clear();
+        aSound.stagedBuffers.clear();
+    }
 
     int priority;
     SoundCategory category;
+    //One of its sounds has two channels, the cue then plays on a stereo source
+    //Never modified after construction, so any thread can read it
+    bool stereo = false;
 
     PlayingSoundCueState state = PlayingSoundCueState_NOT_PLAYING;
-    ALuint source;
+    //Paused by the user, feedCue does not restart its source when it runs dry
+    bool paused = false;
+    //NO_SOURCE while the voice of the cue is virtual
+    ALuint source = NO_SOURCE;
     std::size_t currentPlayingSoundIndex = 0;
     std::size_t currentWaitingForBufferSoundIndex = 0;
-    SoundOption option;
-    std::vector<std::shared_ptr<PlayingSound>> sounds;
-    std::shared_ptr<PlayingSound> interruptSound = nullptr;
+    //Index of the playback in PlayingVoices, only used by the thread calling update()
+    std::size_t voice = 0;
+    std::vector<PlayingSound> sounds;
+    std::optional<PlayingSound> interruptSound;
+
+    PlayingSoundCueSnapshot snapshot;
+    mutable std::mutex snapshotMutex;
+    mutable std::atomic<bool> snapshotRequested = false;
 };
 
-void decodeSoundData(const std::shared_ptr<OggSoundData> & aData, unsigned int aMinSamples);
-void bufferPlayingSound(const std::shared_ptr<PlayingSound> & aSound);
+enum VoiceState
+{
+    VoiceState_PLAYING,
+    VoiceState_PAUSED,
+};
 
-template<typename T>
-struct Handle
+//State of the playing cues that update() goes through every frame.
+//Stored as parallel arrays indexed by voice so update() reads them linearly
+//instead of going through each PlayingSoundCue.
+//A voice without a source is virtual, its cursor keeps moving until it gets a source
+//and resumes from there.
+//Erasing a voice moves the last one in its place and updates PlayingSoundCue::voice
+struct PlayingVoices
 {
-    Handle() :
-        mHandleIndex{-1},
-        mUniqueId{-1}
-    {}
-    Handle(const std::unique_ptr<T> & aCue) :
-        mHandleIndex{aCue->handleIndex},
-        mUniqueId{aCue->id}
-    {}
+    std::size_t add(const Handle<PlayingSoundCue> & aHandle, PlayingSoundCue & aCue, float aDuration)
+    {
+        const std::size_t voice = handles.size();
+        handles.push_back(aHandle);
+        cues.push_back(&aCue);
+        sources.push_back(NO_SOURCE);
+        sourceSlots.push_back(0);
+        states.push_back(VoiceState_PLAYING);
+        categories.push_back(aCue.category);
+        priorities.push_back(aCue.priority);
+        gains.push_back(1.f);
+        positions.push_back(math::Position<3, float>::Zero());
+        velocities.push_back(math::Vec<3, float>::Zero());
+        cursors.push_back(0.f);
+        durations.push_back(aDuration);
+        interrupted.push_back(false);
+        audibilities.push_back(1.f);
+        optionsChanged.push_back(false);
+        loading.push_back(false);
+        promotions.push_back(0);
+        aCue.voice = voice;
+        return voice;
+    }
+
+    void erase(std::size_t aVoice)
+    {
+        const std::size_t last = handles.size() - 1;
+
+        if (aVoice != last)
+        {
+            handles[aVoice] = handles[last];
+            cues[aVoice] = cues[last];
+            sources[aVoice] = sources[last];
+            sourceSlots[aVoice] = sourceSlots[last];
+            states[aVoice] = states[last];
+            categories[aVoice] = categories[last];
+            priorities[aVoice] = priorities[last];
+            gains[aVoice] = gains[last];
+            positions[aVoice] = positions[last];
+            velocities[aVoice] = velocities[last];
+            cursors[aVoice] = cursors[last];
+            durations[aVoice] = durations[last];
+            interrupted[aVoice] = interrupted[last];
+            audibilities[aVoice] = audibilities[last];
+            optionsChanged[aVoice] = optionsChanged[last];
+            loading[aVoice] = loading[last];
+            promotions[aVoice] = promotions[last];
+            cues[aVoice]->voice = aVoice;
+        }
 
-    int mHandleIndex;
-    int mUniqueId;
+        handles.pop_back();
+        cues.pop_back();
+        sources.pop_back();
+        sourceSlots.pop_back();
+        states.pop_back();
+        categories.pop_back();
+        priorities.pop_back();
+        gains.pop_back();
+        positions.pop_back();
+        velocities.pop_back();
+        cursors.pop_back();
+        durations.pop_back();
+        interrupted.pop_back();
+        audibilities.pop_back();
+        optionsChanged.pop_back();
+        loading.pop_back();
+        promotions.pop_back();
+    }
 
-    bool operator<(const Handle<T> & rHs) const
+    SoundOption getOption(std::size_t aVoice) const
     {
-        return mHandleIndex < rHs.mHandleIndex;
+        return {
+            .gain = gains[aVoice],
+            .position = positions[aVoice],
+            .velocity = velocities[aVoice],
+        };
     }
 
-    bool operator==(const Handle<T> & rHs) const
+    void setOption(std::size_t aVoice, const SoundOption & aOption)
     {
-        return mHandleIndex == rHs.mHandleIndex && mUniqueId == rHs.mUniqueId;
+        gains[aVoice] = aOption.gain;
+        positions[aVoice] = aOption.position;
+        velocities[aVoice] = aOption.velocity;
+        optionsChanged[aVoice] = true;
     }
 
-    T * toObject() const;
+    bool isVirtual(std::size_t aVoice) const
+    { return sources[aVoice] == NO_SOURCE; }
+
+    std::size_t size() const
+    { return handles.size(); }
+
+    std::vector<Handle<PlayingSoundCue>> handles;
+    //Only for the streaming done by update(), the feeder thread owns the cues when feeding is threaded
+    std::vector<PlayingSoundCue *> cues;
+    std::vector<ALuint> sources;
+    //Index of the source in SoundManager::mSources, meaningless while the voice is virtual
+    std::vector<std::size_t> sourceSlots;
+    std::vector<VoiceState> states;
+    std::vector<SoundCategory> categories;
+    std::vector<int> priorities;
+    std::vector<float> gains;
+    std::vector<math::Position<3, float>> positions;
+    std::vector<math::Vec<3, float>> velocities;
+    //Seconds played, paused voices do not move
+    std::vector<float> cursors;
+    //Seconds the voice plays for, infinite when it loops forever or its length is not known
+    std::vector<float> durations;
+    //The voice plays the interrupt sound of its cue, its cursor restarted with it
+    std::vector<bool> interrupted;
+    //Gain reaching the listener, with distance attenuation, scored by update()
+    std::vector<float> audibilities;
+    //The option of the voice changed since it was last applied to its source
+    std::vector<bool> optionsChanged;
+    //Sounds of the cue are loaded again, the voice stays virtual and its cursor does not move until they are
+    std::vector<bool> loading;
+    //Times the voice got a source, tells the finished reports of the feeder thread apart
+    std::vector<std::uint32_t> promotions;
+};
+
+DecodedChunk decodeStreamChunk(
+        const OggSoundData & aData,
+        const std::shared_ptr<OggStream> & aStream,
+        bool aRestart,
+        unsigned int aMinSamples,
+        std::size_t aMaxSamples,
+        std::size_t aSkippedSamples);
+void commitDecodedChunk(DecodedChunk && aChunk);
+void rewindStream(OggStream & aStream, const OggSoundData & aData);
+//Restarts the playback stream at aPosition, sounds held in memory seek to it,
+//the decoder of the others drops the samples before it
+void seekStream(OggStream & aStream, const OggSoundData & aData, std::size_t aPosition);
+
+//Seconds of playback, infinite when the sound loops forever or its length is not known
+float getSoundDuration(const PlayingSound & aSound);
+float getCueDuration(const PlayingSoundCue & aCue);
+void bufferPlayingSound(PlayingSound & aSound);
+//Memory held by the sound data once loaded, its static buffer included
+std::size_t getResidentSize(const OggSoundData & aData);
+
+//The least important playback of the category is on top
+typedef PriorityHeap<PlayingSoundCue> PlayingSoundCueQueue;
+
+enum FeederCommandType
+{
+    FeederCommandType_PLAY,
+    FeederCommandType_STOP,
+    FeederCommandType_PAUSE,
+    FeederCommandType_START,
+    FeederCommandType_INTERRUPT,
+    FeederCommandType_OPTION,
 };
 
-bool CmpHandlePriority(const Handle<PlayingSoundCue> & lhs, const Handle<PlayingSoundCue> & rhs);
+//Sent by the game thread to the feeder thread when feeding is threaded
+//The feeder keeps the cue alive until it handles the STOP command
+struct FeederCommand
+{
+    FeederCommandType type = FeederCommandType_PLAY;
+    Handle<PlayingSoundCue> handle{};
+    std::shared_ptr<PlayingSoundCue> cue{};
+    //Where a PLAY command starts the cue
+    ALuint source = NO_SOURCE;
+    float cursor = 0.f;
+    bool interrupted = false;
+    //Promotion of the voice a PLAY command starts, sent back when the cue finishes
+    std::uint32_t promotion = 0;
+    //Applied to the source by PLAY and OPTION commands, its gain includes the category gains
+    SoundOption option{};
+};
 
-typedef std::vector<Handle<PlayingSoundCue>> PlayingSoundCueQueue;
+//Sent by the feeder thread when a cue it feeds is over
+struct FinishedCue
+{
+    Handle<PlayingSoundCue> handle{};
+    //A report from a previous promotion of the voice is ignored
+    std::uint32_t promotion = 0;
+};
 
 struct SoundManagerInfo
 {
-    const std::map<Handle<PlayingSoundCue>, std::unique_ptr<PlayingSoundCue>> & playingCues;
-    const std::array<ALuint, MAX_SOURCES> & sources;
-    const std::vector<std::size_t> & freeSources;
+    const SlotMap<PlayingSoundCue, std::shared_ptr<PlayingSoundCue>> & playingCues;
+    const PlayingVoices & voices;
+    //Mono sources come first, then the stereo ones
+    const std::vector<ALuint> & sources;
+    std::size_t monoSourceCount;
+    //Indexed like sources, a free source is owned by a null handle
+    const std::vector<Handle<PlayingSoundCue>> & sourceOwners;
     const std::unordered_map<handy::StringId, std::shared_ptr<OggSoundData>> & loadedSounds;
+    const BufferPool & bufferPool;
+};
+
+struct PreloadStats
+{
+    //One id per manifest entry, null if the sound could not be loaded
+    std::vector<handy::StringId> soundIds;
+    std::size_t failedCount = 0;
+    std::size_t bytesRead = 0;
+    //Loading time summed over the loading threads
+    std::chrono::duration<double> decodeTime{0};
+    std::chrono::duration<double> elapsedTime{0};
+    //Estimated from the compressed and decoded sizes of the sounds being loaded
+    std::size_t peakMemory = 0;
+};
+
+enum LoadingState
+{
+    LoadingState_NOT_LOADED,
+    LoadingState_LOADING,
+    LoadingState_LOADED,
+};
+
+//Called by update() with the id of the sound and whether it could be loaded
+using LoadingCallback = std::function<void(handy::StringId, bool)>;
+
+struct SoundManagerOption
+{
+    //Number of worker threads decoding streamed data
+    //0 decodes synchronously on the thread calling update()
+    unsigned int decodingThreads = 1;
+
+    //A feeder thread streams buffers to openAL at a fixed period
+    //instead of relying on how often update() is called.
+    //update() then only sends the changed cue options to the feeder and cleans up finished cues.
+    //It never waits on the feeder, commands that do not fit in its queue are sent by a later update()
+    bool threadedFeeding = false;
+    std::chrono::milliseconds feedingPeriod{10};
+
+    //Number of worker threads running the async create functions
+    //0 loads synchronously, the sound is still only published by update()
+    unsigned int loadingThreads = 2;
+
+    //Samples of non streamed sounds are stored in this directory once decoded,
+    //later loads of the same data read them instead of decoding. Empty disables the cache
+    filesystem::path pcmCacheDirectory;
+
+    //Format of the decoded samples, sounds of a manifest can override it
+    SampleFormat sampleFormat = SampleFormat_FLOAT32;
+
+    //Bytes the loaded sounds may hold, 0 is unlimited
+    //Past it update() evicts the least recently played sounds that nothing plays.
+    //A cue playing an evicted sound loads it again on the loading threads,
+    //the playback waits as a virtual voice and starts once the sound is loaded.
+    //Sounds created from an input stream cannot be read again and are never evicted
+    std::size_t memoryBudget = 0;
+
+    //Non streamed sounds drop their decoded samples once they are uploaded to openAL.
+    //Keeping them only helps the debug ui plot them
+    bool keepStaticSamples = false;
+
+    //Sources asked to the device, capped by the ALC_MONO_SOURCES and ALC_STEREO_SOURCES it grants
+    //Cues with a stereo sound only play on stereo sources, the others on mono sources
+    std::size_t monoSources = 28;
+    std::size_t stereoSources = 4;
+
+    //OpenAL buffers generated up front, 0 is enough for each source to play two sounds
+    //The pool grows past it if more are needed
+    std::size_t bufferPoolSize = 0;
+
+    //Playbacks at once, only the most important ones get a source, the others are virtual
+    //Past it a new playback stops the least important playback of its category if it is
+    //less important than itself, otherwise it is not played
+    std::size_t maxVoices = 256;
+
+    //Voices reaching the listener below this gain give back their source
+    //and stay virtual until they are loud enough again
+    float inaudibleGain = 0.001f;
+
+    //Sounds played at a position are limited to maxVoicesPerRadius voices within this radius,
+    //the quietest one is stopped if the new sound is louder. 0 disables the limit
+    float voiceLimitRadius = 0.f;
+    std::size_t maxVoicesPerRadius = 2;
+};
+
+//Playback of a cue waiting for some of its sounds to be loaded again
+struct LoadingPlayback
+{
+    Handle<PlayingSoundCue> handle;
+    //Sounds of the cue when it was played, it may be destroyed while they load
+    std::vector<std::pair<handy::StringId, CueElementOption>> sounds;
+    handy::StringId interruptSound = handy::StringId::Null();
+};
+
+struct LoadingOption
+{
+    SampleFormat sampleFormat = SampleFormat_FLOAT32;
+    filesystem::path pcmCacheDirectory;
 };
 
 //There is three step to play sound
@@ -292,7 +754,7 @@ struct SoundManagerInfo
 class SoundManager
 {
     public:
-        SoundManager(std::vector<SoundCategory> && aCategories);
+        SoundManager(std::vector<SoundCategory> && aCategories, const SoundManagerOption & aOption = {});
         ~SoundManager();
 
         handy::StringId createData(const filesystem::path & aPath);
@@ -301,7 +763,58 @@ class SoundManager
         handy::StringId createStreamedOggData(const filesystem::path & aPath);
         handy::StringId createStreamedOggData(const std::shared_ptr<std::istream> & aInputStream, handy::StringId aSoundId);
 
+        //Only keeps the compressed sound in memory, each playback decodes it when it starts
+        //Meant for short and rarely played sounds
+        handy::StringId createCompressedData(const filesystem::path & aPath);
+        handy::StringId createCompressedData(const std::shared_ptr<std::istream> & aInputStream, handy::StringId aSoundId);
+
+        //Async versions return the sound id right away, the sound can be used once
+        //getLoadingState() returns LOADED. The callback is called by update(),
+        //or right away if the sound is already loaded.
+        //The stream is read on a loading thread and must not be used until then
+        handy::StringId createDataAsync(const filesystem::path & aPath, LoadingCallback aCallback = {});
+        handy::StringId createDataAsync(
+                const std::shared_ptr<std::istream> & aInputStream,
+                handy::StringId aSoundId,
+                LoadingCallback aCallback = {});
+
+        handy::StringId createStreamedOggDataAsync(const filesystem::path & aPath, LoadingCallback aCallback = {});
+        handy::StringId createStreamedOggDataAsync(
+                const std::shared_ptr<std::istream> & aInputStream,
+                handy::StringId aSoundId,
+                LoadingCallback aCallback = {});
+
+        handy::StringId createCompressedDataAsync(const filesystem::path & aPath, LoadingCallback aCallback = {});
+        handy::StringId createCompressedDataAsync(
+                const std::shared_ptr<std::istream> & aInputStream,
+                handy::StringId aSoundId,
+                LoadingCallback aCallback = {});
+
+        LoadingState getLoadingState(handy::StringId aSoundId) const;
+
+        //Loads every sound of the manifest in parallel on the loading threads
+        //and blocks until they are all published
+        PreloadStats preloadSounds(const std::vector<SoundManifestEntry> & aManifest);
+
+        //Maps the bank once and registers all its sounds
+        //A sound is only decoded the first time a cue is created with it
+        std::vector<handy::StringId> loadSoundBank(const filesystem::path & aPath);
+
+        //Each create function, preload or bank loading a sound takes a reference to it.
+        //unloadData releases one and unloads the sound with the last one, then returns true.
+        //Playbacks already started keep their sound until they end, cues using it cannot play anymore.
+        //Unloading a sound that is still loading drops it when it is done
+        bool unloadData(handy::StringId aSoundId);
+        //Releases every sound of a level, like the ids returned by preloadSounds or loadSoundBank
+        void unloadSounds(const std::vector<handy::StringId> & aSoundIds);
+
+        //Memory held by the loaded sounds, as counted by the memory budget
+        std::size_t getResidentMemory() const
+        { return mResidentSize; }
+
         Handle<PlayingSoundCue> playSound(const Handle<SoundCue> & aSoundCue);
+        //Plays the cue already placed, it is subject to the voice limit around its position
+        Handle<PlayingSoundCue> playSound(const Handle<SoundCue> & aSoundCue, const SoundOption & aOption);
 
         bool stopSound(const Handle<PlayingSoundCue> & aHandle);
         void stopCategory(SoundCategory aSoundCategory);
@@ -317,6 +830,12 @@ class SoundManager
 
         bool interruptSound(const Handle<PlayingSoundCue> & aHandle);
 
+        //Gain, position and velocity of a playback, applied by the next update()
+        bool setSoundOption(const Handle<PlayingSoundCue> & aHandle, const SoundOption & aOption);
+        std::optional<SoundOption> getSoundOption(const Handle<PlayingSoundCue> & aHandle) const;
+        //Lower values are more important, applied by the next update()
+        bool setSoundPriority(const Handle<PlayingSoundCue> & aHandle, int aPriority);
+
         ALint getSourceState(ALuint aSource);
         Handle<SoundCue> createSoundCue(
                 const std::vector<std::pair<handy::StringId, CueElementOption>> & aSoundList,
@@ -324,6 +843,8 @@ class SoundManager
                 int priority,
                 const handy::StringId & aInterruptSoundId = handy::StringId::Null()
                 );
+        //Playbacks of the cue keep playing until they end
+        bool destroySoundCue(const Handle<SoundCue> & aHandle);
 
         void update();
         void updateCue(PlayingSoundCue & currentCue, const Handle<PlayingSoundCue> & aHandle);
@@ -333,25 +854,148 @@ class SoundManager
 
 
     private:
+        LoadingOption getLoadingOption(std::optional<SampleFormat> aSampleFormat) const;
+        handy::StringId addLoadedSound(const std::shared_ptr<OggSoundData> & aSoundData);
+        //Returns the memory the sound held
+        std::size_t eraseLoadedSound(handy::StringId aSoundId);
+        handy::StringId loadSound(handy::StringId aSoundId, SoundLoader aLoad, bool aReloadable);
+        std::shared_ptr<OggSoundData> getSoundData(handy::StringId aSoundId);
+        //Returns nullptr while an evicted sound is loaded again
+        std::shared_ptr<OggSoundData> requestSoundData(handy::StringId aSoundId);
+        void pushLoad(handy::StringId aSoundId, SoundLoader aLoad);
+        void loadAsync(
+                handy::StringId aSoundId,
+                SoundLoader aLoad,
+                LoadingCallback aCallback,
+                bool aReloadable);
+        void collectLoadResults();
+        //Gives the loading playbacks their sounds once they are loaded, stops them if one could not be
+        void resolveLoadingPlaybacks();
+
+        void markPlayed(handy::StringId aSoundId);
+        void evictSounds();
+
+        void requestDecode(const PlayingSound & aSound, unsigned int aMinSamples);
+        void collectDecodedChunks();
+
+        Handle<PlayingSoundCue> playCue(const Handle<SoundCue> & aSoundCue, const SoundOption & aOption, bool aPlaced);
+        //Returns false when the voices around aOption.position are all louder than the new one.
+        //Otherwise aStolenVoice is the voice to stop for the new one, or a null handle.
+        //aStoppedVoice is already going to stop, it is not counted
+        bool limitVoicesAround(
+                const SoundOption & aOption,
+                SoundCategory aCategory,
+                const Handle<PlayingSoundCue> & aStoppedVoice,
+                Handle<PlayingSoundCue> & aStolenVoice);
+        void primeStreamedSound(const PlayingSound & aSound);
+        void prepareStreamedSound(const PlayingSound & aSound);
+        //Returns false when the cue is already over at aCursor
+        bool startCue(PlayingSoundCue & aCue, ALuint aSource, float aCursor, bool aInterrupted);
+        //Option of the voice with the gain of its source
+        SoundOption getSourceOption(std::size_t aVoice) const;
+        //Only applies a changed option. Sent to the feeder thread when feeding is threaded,
+        //the option stays changed and is sent by a later update() if the command queue is full
+        void applyVoiceOption(std::size_t aVoice);
+        //Returns true when the cue is finished
+        bool feedCue(PlayingSoundCue & aCue);
+        bool interruptCue(PlayingSoundCue & aCue);
+
+        void releaseStoppedCues();
+
+        void advanceVoices(float aElapsed);
+        //Category gain times master gain
+        float getCategoryGain(SoundCategory aCategory) const;
+        //Gain of the voice with its category and master gains, before distance attenuation
+        float getVoiceGain(std::size_t aVoice) const;
+        void scoreVoices();
+        //Gives the sources to the most important voices
+        void assignSources();
+        void assignSources(
+                std::vector<std::size_t>::iterator aBegin,
+                std::vector<std::size_t>::iterator aEnd,
+                bool aStereo);
+        std::vector<std::size_t> & getFreeSources(bool aStereo)
+        { return aStereo ? mFreeStereoSources : mFreeMonoSources; }
+        void promoteVoice(std::size_t aVoice, std::size_t aSourceIndex);
+        void demoteVoice(std::size_t aVoice);
+        void releaseSource(std::size_t aSourceIndex);
+        PlayingSoundCue * findPlayingCue(const Handle<PlayingSoundCue> & aHandle) const;
+
+        //Commands that do not fit in the queue wait in mOverflowFeederCommands, in order
+        void pushFeederCommand(const FeederCommand & aCommand);
+        //Returns false when commands are still waiting for room in the queue
+        bool flushFeederCommands();
+        void feed();
+
         std::map<SoundCategory, PlayingSoundCueQueue> mCuesByCategories;
         std::map<
             SoundCategory, CategoryOption> mCategoryOptions;
         std::map<Handle<SoundCue>, std::vector<Handle<PlayingSoundCue>>> mPlayingCuesByCue;
+        //Handles resolve through these maps, so each manager only sees its own cues
+        SlotMap<SoundCue, SoundCue> mCues;
+        //A stopped cue holds nullptr until its slot is released
+        SlotMap<PlayingSoundCue, std::shared_ptr<PlayingSoundCue>> mPlayingCues;
+        //Only holds the cues that are not stopped
+        PlayingVoices mVoices;
 
         ALCdevice * mOpenALDevice;
         ALCcontext * mOpenALContext;
         ALCboolean mContextIsCurrent;
 
         std::unordered_map<handy::StringId, std::shared_ptr<OggSoundData>> mLoadedSounds;
-
-        std::array<ALuint, MAX_SOURCES> mSources;
-        std::vector<std::size_t> mFreeSources;
-
-        std::size_t mCurrentCueId = 0;
+        std::unordered_map<handy::StringId, std::vector<LoadingCallback>> mPendingLoads;
+        //Sounds that can be loaded again, either never loaded yet like the sounds of a bank or evicted
+        std::unordered_map<handy::StringId, SoundLoader> mSoundLoaders;
+        std::unordered_map<handy::StringId, int> mSoundReferences;
+        LoadingOption mLoadingOption;
+        std::size_t mMemoryBudget;
+        bool mKeepStaticSamples;
+        std::size_t mResidentSize = 0;
+        //Loaded sounds from the least to the most recently played
+        std::list<handy::StringId> mPlayedSounds;
+        std::unordered_map<handy::StringId, std::list<handy::StringId>::iterator> mPlayedSoundPositions;
+        std::vector<std::pair<handy::StringId, std::shared_ptr<OggSoundData>>> mLoadResults;
+        std::mutex mLoadResultsMutex;
+        std::vector<LoadingPlayback> mLoadingPlaybacks;
+
+        //Mono sources come first, then the stereo ones
+        std::vector<ALuint> mSources;
+        std::size_t mMonoSourceCount = 0;
+        std::size_t mMaxVoices;
+        float mInaudibleGain;
+        float mVoiceLimitRadius;
+        std::size_t mMaxVoicesPerRadius;
+        //Playing voices by position, rebuilt by scoreVoices() and holding the voices placed since
+        SpatialGrid<Handle<PlayingSoundCue>> mVoiceGrid;
+        std::chrono::steady_clock::time_point mLastUpdate;
+        //Scratch storage of assignSources()
+        std::vector<std::size_t> mRankedVoices;
+        BufferPool mBufferPool;
+        //Playing cue holding each source, indexed like mSources
+        std::vector<Handle<PlayingSoundCue>> mSourceOwners;
+        std::vector<std::size_t> mFreeMonoSources;
+        std::vector<std::size_t> mFreeStereoSources;
+
+        //Stopped cues keep their slot until update() is done iterating on the playing cues
+        std::vector<Handle<PlayingSoundCue>> mStoppedCues;
+
+        std::vector<DecodedChunk> mDecodedChunks;
+        std::mutex mDecodedChunksMutex;
+
+        bool mThreadedFeeding;
+        std::chrono::milliseconds mFeedingPeriod;
+        CommandQueue<FeederCommand, FEEDER_QUEUE_SIZE> mFeederCommands;
+        //Commands sent while the queue was full, the game thread never waits on the feeder
+        std::deque<FeederCommand> mOverflowFeederCommands;
+        CommandQueue<FinishedCue, FEEDER_QUEUE_SIZE> mFinishedCues;
+        std::atomic<bool> mFeeding = false;
+        std::thread mFeeder;
+
+        //Last members so workers are joined before anything they use is destroyed
+        DecoderPool mDecoderPool;
+        DecoderPool mLoadingPool;
 };
 
-inline std::map<Handle<SoundCue>, std::unique_ptr<SoundCue>> mCues;
-inline std::map<Handle<PlayingSoundCue>, std::unique_ptr<PlayingSoundCue>> mPlayingCues;
 
 } // namespace grapito
 } // namespace ad
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <math/Vector.h>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ad {
+namespace sounds {
+
+//Uniform grid bucketing items by position
+//Cells are as wide as the query radius, so a query only visits the 27 cells around its position
+template<typename T>
+class SpatialGrid
+{
+    public:
+        void reset(float aCellSize)
+        {
+            mCellSize = aCellSize;
+            clear();
+        }
+
+        //Cells are kept so the grid stops allocating once it covers the played area
+        void clear()
+        {
+            for (auto & [coordinates, items] : mCells)
+            {
+                items.clear();
+            }
+        }
+
+        void insert(const math::Position<3, float> & aPosition, T aItem)
+        {
+            mCells[getCell(aPosition)].push_back({aPosition, std::move(aItem)});
+        }
+
+        //Calls aVisit with each item closer than mCellSize to aPosition
+        template<typename T_visitor>
+        void forEachAround(const math::Position<3, float> & aPosition, T_visitor && aVisit) const
+        {
+            const Coordinates center = getCell(aPosition);
+            const float radiusSquared = mCellSize * mCellSize;
+
+            for (int x = -1; x <= 1; x++)
+            {
+                for (int y = -1; y <= 1; y++)
+                {
+                    for (int z = -1; z <= 1; z++)
+                    {
+                        auto cell = mCells.find({center[0] + x, center[1] + y, center[2] + z});
+                        if (cell == mCells.end())
+                        {
+                            continue;
+                        }
+
+                        for (const auto & [position, item] : cell->second)
+                        {
+                            const float dx = position.x() - aPosition.x();
+                            const float dy = position.y() - aPosition.y();
+                            const float dz = position.z() - aPosition.z();
+                            if (dx * dx + dy * dy + dz * dz <= radiusSquared)
+                            {
+                                aVisit(item);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        using Coordinates = std::array<int, 3>;
+
+        struct CoordinatesHash
+        {
+            std::size_t operator()(const Coordinates & aCoordinates) const
+            {
+                //Large primes spread neighbouring cells over the buckets
+                return static_cast<std::size_t>(aCoordinates[0]) * 73856093
+                    ^ static_cast<std::size_t>(aCoordinates[1]) * 19349663
+                    ^ static_cast<std::size_t>(aCoordinates[2]) * 83492791;
+            }
+        };
+
+        Coordinates getCell(const math::Position<3, float> & aPosition) const
+        {
+            return {
+                static_cast<int>(std::floor(aPosition.x() / mCellSize)),
+                static_cast<int>(std::floor(aPosition.y() / mCellSize)),
+                static_cast<int>(std::floor(aPosition.z() / mCellSize)),
+            };
+        }
+
+        float mCellSize = 1.f;
+        std::unordered_map<Coordinates, std::vector<std::pair<math::Position<3, float>, T>>, CoordinatesHash> mCells;
+};
+
+} // namespace sounds
+} // namespace ad
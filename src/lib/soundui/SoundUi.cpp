@@ -7,7 +7,6 @@ namespace ad {
 namespace sounds {
 
 constexpr int SOURCE_RECT_SIZE = 20;
-constexpr int MAX_SAMPLE_DRAWN = 10000;
 
 void DisplaySoundUi(const SoundManagerInfo & managerInfo)
 {
@@ -20,7 +19,8 @@ void DisplaySoundUi(const SoundManagerInfo & managerInfo)
             ImGui::Text("Sources");
             ImGui::Separator();
             ImGui::Spacing();
-            static ALuint hovered = -1;
+            //Index of the hovered source
+            static std::size_t hovered = -1;
 
             // Show Sources
             ImGui::BeginGroup();
@@ -32,64 +32,85 @@ void DisplaySoundUi(const SoundManagerInfo & managerInfo)
 
                 char popupName[32];
 
-                if (std::find(managerInfo.freeSources.begin(),
-                              managerInfo.freeSources.end(), i)
-                    == managerInfo.freeSources.end()) {
-                    drawList->AddRectFilled(ImVec2(x, y), ImVec2(x + size, y + size),
-                                            ImColor(1.f, 1.f, 0.f, 1.f));
+                //Mono sources are yellow, stereo sources are cyan
+                const bool stereo = i >= managerInfo.monoSourceCount;
+                const ImColor color = stereo ? ImColor(0.f, 1.f, 1.f, 1.f) : ImColor(1.f, 1.f, 0.f, 1.f);
+
+                if (managerInfo.sourceOwners[i] != ad::sounds::Handle<ad::sounds::PlayingSoundCue>()) {
+                    drawList->AddRectFilled(ImVec2(x, y), ImVec2(x + size, y + size), color);
                 } else {
-                    drawList->AddRect(ImVec2(x, y), ImVec2(x + size, y + size),
-                                      ImColor(1.f, 1.f, 0.f, 1.f));
+                    drawList->AddRect(ImVec2(x, y), ImVec2(x + size, y + size), color);
                 }
 
                 //ImGui::SetCursorScreenPos(position);
                 if(ImGui::Button(popupName, ImVec2{(float)size, (float)size}))
                 {
-                    hovered = managerInfo.sources[i];
+                    hovered = i;
                 }
                 ImGui::SameLine();
             }
             ImGui::EndGroup();
-            ImGui::Text("hovered: %d", hovered);
+            if (hovered < managerInfo.sources.size())
+            {
+                ImGui::Text("hovered: %u", managerInfo.sources[hovered]);
+            }
+            ImGui::Text("Buffer pool: %zu buffers, %zu free, at most %zu in use",
+                    managerInfo.bufferPool.getSize(),
+                    managerInfo.bufferPool.getFreeCount(),
+                    managerInfo.bufferPool.getHighWaterMark());
+            ImGui::Text("Voices: %zu, %zu virtual",
+                    managerInfo.voices.size(),
+                    static_cast<std::size_t>(std::count(
+                            managerInfo.voices.sources.begin(),
+                            managerInfo.voices.sources.end(),
+                            ad::sounds::NO_SOURCE)));
 
             ImGui::BeginGroup();
-            if (hovered != -1)
+            if (hovered < managerInfo.sourceOwners.size())
             {
-                const auto & cueIt = std::find_if(managerInfo.playingCues.begin(), managerInfo.playingCues.end(),[](auto & cue){
-                    if (cue.second != nullptr)
-                    {
-                        return cue.second->source == hovered;
-                    }
-
-                    return false;
-                });
-                if (cueIt != managerInfo.playingCues.end())
+                const ad::sounds::PlayingVoices & voices = managerInfo.voices;
+                const ad::sounds::PlayingSoundCue * owner = managerInfo.sourceOwners[hovered].toObject();
+                if (owner != nullptr)
                 {
-                    const ad::sounds::PlayingSoundCue & cue = *cueIt->second;
-                    const ad::sounds::PlayingSound * playingSound = cue.getPlayingSound().get();
-                    const ad::sounds::PlayingSound * waitingSound = cue.getWaitingSound().get();
+                    const std::size_t voice = owner->voice;
+                    const ad::sounds::PlayingSoundCue & cue = *owner;
+                    //The streaming state of the cue belongs to the thread feeding it,
+                    //asking for its snapshot has it published by the next feed
+                    const ad::sounds::PlayingSoundCueSnapshot snapshot = cue.getSnapshot();
 
                     ImGui::Spacing();
                     ImGui::Text("Playing cue info");
                     ImGui::Separator();
                     ImGui::Text("Category: %d", cue.category);
-                    ImGui::Text("Gain: %f", cue.option.gain);
+                    ImGui::Text("Gain: %f", voices.gains[voice]);
+                    ImGui::Text("Cursor: %f / %f", voices.cursors[voice], voices.durations[voice]);
+                    ImGui::Text("Audibility: %f", voices.audibilities[voice]);
                     ImGui::Separator();
-                    ImGui::Text("Currently playing sound: %s", revertStringId(playingSound->soundData->soundId).c_str());
-                    ImGui::Text("Currently waiting sound: %s", revertStringId(waitingSound->soundData->soundId).c_str());
+                    ImGui::Text("Currently playing sound: %s", revertStringId(snapshot.playingSoundId).c_str());
+                    ImGui::Text("Currently waiting sound: %s", revertStringId(snapshot.waitingSoundId).c_str());
                     ImGui::Spacing();
 
                     ImGui::Text("Sound list");
                     ImGui::Separator();
 
-                    for (const std::shared_ptr<ad::sounds::PlayingSound> & sound : cue.sounds)
+                    for (const ad::sounds::PlayingSoundSnapshot & sound : snapshot.sounds)
                     {
-                        if (ImGui::CollapsingHeader(revertStringId(sound->soundData->soundId).c_str(), ImGuiTreeNodeFlags_None))
+                        if (ImGui::CollapsingHeader(revertStringId(sound.soundId).c_str(), ImGuiTreeNodeFlags_None))
                         {
-                            ImGui::Text("Loops %d", sound->loops);
-                            ImGui::Text("buffers %zu", sound->buffers.size());
-                            ImGui::Text("stagedBuffers %zu", sound->stagedBuffers.size());
-                            ImGui::Text("freeBuffers %zu", sound->freeBuffers.size());
+                            ImGui::Text("Loops %d", sound.loops);
+                            ImGui::Text("buffers %zu", sound.bufferCount);
+                            ImGui::Text("stagedBuffers %zu", sound.stagedBufferCount);
+                            ImGui::Text("freeBuffers %zu", sound.freeBufferCount);
+                            ImGui::Text("position %zu", sound.positionInData);
+                            if (sound.streamed)
+                            {
+                                ImGui::Text("Stream used data %zu", sound.streamUsedData);
+                                ImGui::Text("Ring: %zu to %zu (capacity %zu)",
+                                        sound.ringStart,
+                                        sound.ringEnd,
+                                        sound.ringCapacity);
+                                ImGui::Text("Is fully decoded: %d", sound.fullyDecoded);
+                            }
                         }
                     }
                 }
@@ -102,8 +123,7 @@ void DisplaySoundUi(const SoundManagerInfo & managerInfo)
         // Show Data
         if (ImGui::BeginTabItem("Loaded sound data")) {
             ImGui::BeginChild("sound list", ImVec2(150.f, 0.f), true);
-            static ad::handy::StringId selectedSound{
-                managerInfo.loadedSounds.begin()->first};
+            static ad::handy::StringId selectedSound = ad::handy::StringId::Null();
             for (auto [stringId, sound] : managerInfo.loadedSounds) {
                 char label[64];
                 sprintf(label, "%s", ad::handy::revertStringId(stringId).c_str());
@@ -118,76 +138,65 @@ void DisplaySoundUi(const SoundManagerInfo & managerInfo)
             ImGui::EndChild();
             ImGui::SameLine();
 
-            std::shared_ptr<ad::sounds::OggSoundData> sound =
-                managerInfo.loadedSounds.at(selectedSound);
-
-            ImGui::BeginChild("sound data view");
-            ImGui::Text("Sound info");
-            ImGui::Separator();
-            ImGui::Text("sample rate: %d", sound->vorbisInfo.sample_rate);
-            ImGui::Text("channels: %d", sound->vorbisInfo.channels);
-            ImGui::Spacing();
-
-            ImGui::Text("Stream info");
-            ImGui::Separator();
-            ImGui::Text("length read: %lu", sound->lengthRead);
-            ImGui::Text("Used data size: %lu", sound->usedData);
-            ImGui::Text("Is fully read: %d", sound->fullyRead);
-            ImGui::Spacing();
-
-            ImGui::Text("Raw data info");
-            ImGui::Separator();
-            ImGui::Text("length decoded: %lu", sound->lengthDecoded);
-            ImGui::Text("Is fully decoded: %d", sound->fullyDecoded);
-            ImGui::Spacing();
+            //The selected sound may have been evicted or unloaded
+            if (!managerInfo.loadedSounds.contains(selectedSound) && !managerInfo.loadedSounds.empty())
+            {
+                selectedSound = managerInfo.loadedSounds.begin()->first;
+                newSelection = true;
+            }
 
-            ImGui::Text("Raw data info");
-            ImGui::Separator();
-            if (sound->decodedData.size() && ImPlot::BeginPlot("Decoded data", ImVec2(-1, 0),
-                                  ImPlotFlags_CanvasOnly)) {
-                if (!sound->streamedData)
-                {
+            if (managerInfo.loadedSounds.contains(selectedSound))
+            {
+                std::shared_ptr<ad::sounds::OggSoundData> sound =
+                    managerInfo.loadedSounds.at(selectedSound);
+
+                ImGui::BeginChild("sound data view");
+                ImGui::Text("Sound info");
+                ImGui::Separator();
+                ImGui::Text("sample rate: %d", sound->vorbisInfo.sample_rate);
+                ImGui::Text("channels: %d", sound->vorbisInfo.channels);
+                ImGui::Spacing();
+
+                ImGui::Text("Stream info");
+                ImGui::Separator();
+                ImGui::Text("Is streamed: %d", sound->streamedData);
+                ImGui::Text("Is compressed resident: %d", sound->compressedResident);
+                ImGui::Text("Header size: %lu", sound->headerData.size());
+                ImGui::Text("Compressed data in memory: %lu", sound->compressedData.size());
+                ImGui::Text("Used data size: %lu", sound->usedData);
+                ImGui::Spacing();
+
+                ImGui::Text("Raw data info");
+                ImGui::Separator();
+                ImGui::Text("length decoded: %lu", sound->lengthDecoded);
+                ImGui::Text("Sample format: %s", sound->sampleFormat == SampleFormat_INT16 ? "int16" : "float32");
+                ImGui::Text("Is fully decoded: %d", sound->fullyDecoded);
+                ImGui::Spacing();
+
+                //Streamed sound only shows its first samples, the rest is decoded by each playback
+                ImGui::Text("Raw data info");
+                ImGui::Separator();
+                if (!sound->getDecodedSamples().empty() && ImPlot::BeginPlot("Decoded data", ImVec2(-1, 0),
+                                      ImPlotFlags_CanvasOnly)) {
                     ImPlot::SetupAxes(
                             NULL, NULL,
                             newSelection ? ImPlotAxisFlags_AutoFit : 0 | (ImPlotAxisFlags_NoDecorations ^ ImPlotAxisFlags_NoGridLines),
                             ImPlotAxisFlags_AutoFit | (ImPlotAxisFlags_NoDecorations ^ ImPlotAxisFlags_NoGridLines));
-                    ImPlot::PlotLine("", sound->decodedData.data(),
-                                     sound->decodedData.size());
-                    newSelection = false;
-                }
-                else
-                {
-                    ImPlot::SetupAxes(
-                            NULL, NULL, ImPlotAxisFlags_NoDecorations ^ ImPlotAxisFlags_NoGridLines,  ImPlotAxisFlags_NoDecorations ^ ImPlotAxisFlags_NoGridLines);
-
-                    int sampleDrawn = sound->decodedData.size();
-                    int realSampleDrawn = std::min((std::size_t)MAX_SAMPLE_DRAWN, sound->decodedData.size());
-                    sampleDrawn = std::max(0, sampleDrawn - (sampleDrawn % realSampleDrawn));
-                    int sampleStride = sampleDrawn / realSampleDrawn;
-
-                    float drawnSampleToTotalReadSize = (float)sound->usedData / (float)sound->lengthRead;
-                    float plotLengthOfReadData = (float)realSampleDrawn / drawnSampleToTotalReadSize;
-
-                    ImPlot::SetupAxesLimits(0.f, plotLengthOfReadData, -1.f, 1.f, ImPlotCond_Always);
-
-                    ImVec2 rmin = ImPlot::PlotToPixels(ImPlotPoint(0.f, -1.f));
-                    ImVec2 rmax = ImPlot::PlotToPixels(ImPlotPoint(plotLengthOfReadData, 1.f));
-                    ImPlot::PushPlotClipRect();
-                    ImPlot::GetPlotDrawList()->AddRectFilled(rmin, rmax, ImColor(1.f, 0.6f, 0.1f, 0.2f));
-                    ImPlot::GetPlotDrawList()->AddRect(rmin, rmax, ImColor(1.f, 0.6f, 0.1f, 0.8f));
-                    ImPlot::PopPlotClipRect();
-
-                    ImPlot::PlotLine("",
-                            sound->decodedData.data(),
-                            realSampleDrawn, 1, 0, 0, sizeof(float) * sampleStride);
-
-
+                    if (sound->sampleFormat == SampleFormat_INT16)
+                    {
+                        ImPlot::PlotLine("", reinterpret_cast<const ImS16 *>(sound->getDecodedSamples().data()),
+                                         static_cast<int>(sound->lengthDecoded));
+                    }
+                    else
+                    {
+                        ImPlot::PlotLine("", reinterpret_cast<const float *>(sound->getDecodedSamples().data()),
+                                         static_cast<int>(sound->lengthDecoded));
+                    }
                     newSelection = false;
-                    
+                    ImPlot::EndPlot();
                 }
-                ImPlot::EndPlot();
+                ImGui::EndChild();
             }
-            ImGui::EndChild();
 
             ImGui::EndTabItem();
         }
@@ -0,0 +1,132 @@
+#include <catch2/catch.hpp>
+
+#include <sounds/CommandQueue.h>
+
+#include <memory>
+#include <thread>
+
+
+using namespace ad::sounds;
+
+
+SCENARIO("Command queue reports when it is full or empty.")
+{
+    GIVEN("An empty queue of capacity 3.")
+    {
+        CommandQueue<int, 3> queue;
+        int command = -1;
+
+        THEN("Nothing can be popped.")
+        {
+            REQUIRE_FALSE(queue.pop(command));
+            REQUIRE(command == -1);
+        }
+
+        WHEN("It is filled.")
+        {
+            REQUIRE(queue.push(1));
+            REQUIRE(queue.push(2));
+            REQUIRE(queue.push(3));
+
+            THEN("A push fails and keeps the queued commands.")
+            {
+                REQUIRE_FALSE(queue.push(4));
+
+                REQUIRE(queue.pop(command));
+                REQUIRE(command == 1);
+                REQUIRE(queue.pop(command));
+                REQUIRE(command == 2);
+                REQUIRE(queue.pop(command));
+                REQUIRE(command == 3);
+                REQUIRE_FALSE(queue.pop(command));
+            }
+
+            THEN("A pop frees a slot for one more push.")
+            {
+                REQUIRE(queue.pop(command));
+                REQUIRE(queue.push(4));
+                REQUIRE_FALSE(queue.push(5));
+            }
+        }
+
+        WHEN("Commands go through it many times its capacity.")
+        {
+            THEN("They come out in order across the wrap point.")
+            {
+                int expected = 0;
+                for (int pushed = 0; pushed < 20; pushed++)
+                {
+                    REQUIRE(queue.push(pushed));
+                    if (pushed % 2 == 1)
+                    {
+                        REQUIRE(queue.pop(command));
+                        REQUIRE(command == expected++);
+                        REQUIRE(queue.pop(command));
+                        REQUIRE(command == expected++);
+                    }
+                }
+                REQUIRE_FALSE(queue.pop(command));
+            }
+        }
+    }
+
+    GIVEN("A queue of owning commands.")
+    {
+        CommandQueue<std::shared_ptr<int>, 2> queue;
+        std::shared_ptr<int> value = std::make_shared<int>(5);
+
+        WHEN("A command is pushed and popped.")
+        {
+            REQUIRE(queue.push(value));
+            std::shared_ptr<int> command;
+            REQUIRE(queue.pop(command));
+
+            THEN("The queue does not keep a reference to it.")
+            {
+                REQUIRE(*command == 5);
+                REQUIRE(value.use_count() == 2);
+            }
+        }
+    }
+
+    GIVEN("A producer and a consumer thread.")
+    {
+        CommandQueue<int, 8> queue;
+        constexpr int commandCount = 10000;
+
+        THEN("Every command is received once and in order.")
+        {
+            std::thread producer{[&queue]()
+            {
+                for (int i = 0; i < commandCount; i++)
+                {
+                    while (!queue.push(i))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }};
+
+            int expected = 0;
+            bool ordered = true;
+            while (expected < commandCount)
+            {
+                int command = -1;
+                if (queue.pop(command))
+                {
+                    ordered = ordered && command == expected;
+                    expected++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            producer.join();
+
+            REQUIRE(ordered);
+            int command = -1;
+            REQUIRE_FALSE(queue.pop(command));
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+
+#include <sounds/PriorityHeap.h>
+#include <sounds/SlotMap.h>
+
+#include <vector>
+
+
+using namespace ad::sounds;
+
+
+namespace {
+
+//Pops every entry of aHeap, greatest priority first
+std::vector<int> drain(PriorityHeap<int> & aHeap)
+{
+    std::vector<int> priorities;
+    while (!aHeap.empty())
+    {
+        priorities.push_back(aHeap.top().priority);
+        aHeap.erase(aHeap.top().handle);
+    }
+    return priorities;
+}
+
+} // anonymous namespace
+
+
+SCENARIO("Priority heap keeps the greatest priority on top.")
+{
+    GIVEN("A heap of five handles.")
+    {
+        SlotMap<int, int> slotMap;
+        PriorityHeap<int> heap;
+        std::vector<Handle<int>> handles;
+        for (int priority : {3, 1, 4, 5, 2})
+        {
+            handles.push_back(slotMap.insert(priority));
+            heap.push(handles.back(), priority);
+        }
+
+        THEN("The greatest priority is on top.")
+        {
+            REQUIRE(heap.size() == 5);
+            REQUIRE(heap.top().priority == 5);
+            REQUIRE(heap.top().handle == handles[3]);
+        }
+
+        WHEN("A handle gets a greater priority.")
+        {
+            REQUIRE(heap.setPriority(handles[1], 10));
+
+            THEN("It moves on top.")
+            {
+                REQUIRE(heap.top().handle == handles[1]);
+                REQUIRE(drain(heap) == std::vector<int>{10, 5, 4, 3, 2});
+            }
+        }
+
+        WHEN("The top handle gets a lower priority.")
+        {
+            REQUIRE(heap.setPriority(handles[3], 0));
+
+            THEN("It moves down.")
+            {
+                REQUIRE(heap.top().handle == handles[2]);
+                REQUIRE(drain(heap) == std::vector<int>{4, 3, 2, 1, 0});
+            }
+        }
+
+        WHEN("A handle in the middle is erased.")
+        {
+            REQUIRE(heap.erase(handles[0]));
+
+            THEN("It cannot be erased or updated again.")
+            {
+                REQUIRE_FALSE(heap.erase(handles[0]));
+                REQUIRE_FALSE(heap.setPriority(handles[0], 10));
+            }
+
+            THEN("The other handles keep their order.")
+            {
+                REQUIRE(heap.size() == 4);
+                REQUIRE(drain(heap) == std::vector<int>{5, 4, 2, 1});
+            }
+        }
+
+        WHEN("The last entry is erased.")
+        {
+            const Handle<int> last = (heap.end() - 1)->handle;
+            REQUIRE(heap.erase(last));
+
+            THEN("The other handles keep their order.")
+            {
+                REQUIRE(heap.size() == 4);
+                REQUIRE(drain(heap).size() == 4);
+            }
+        }
+
+        WHEN("An erased handle's slot is reused by a new handle.")
+        {
+            REQUIRE(heap.erase(handles[4]));
+            slotMap.erase(handles[4]);
+            Handle<int> reused = slotMap.insert(6);
+            REQUIRE(reused.mHandleIndex == handles[4].mHandleIndex);
+
+            THEN("The stale handle does not reach the new one.")
+            {
+                heap.push(reused, 6);
+                REQUIRE_FALSE(heap.erase(handles[4]));
+                REQUIRE_FALSE(heap.setPriority(handles[4], 0));
+                REQUIRE(heap.top().handle == reused);
+            }
+        }
+    }
+
+    GIVEN("A handle that was never pushed.")
+    {
+        SlotMap<int, int> slotMap;
+        PriorityHeap<int> heap;
+        Handle<int> pushed = slotMap.insert(1);
+        Handle<int> other = slotMap.insert(2);
+        heap.push(pushed, 1);
+
+        THEN("It cannot be erased or updated.")
+        {
+            REQUIRE_FALSE(heap.erase(other));
+            REQUIRE_FALSE(heap.setPriority(other, 3));
+            REQUIRE_FALSE(heap.erase(Handle<int>{}));
+            REQUIRE(heap.size() == 1);
+        }
+    }
+}
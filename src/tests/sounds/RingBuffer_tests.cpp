@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+
+#include <sounds/RingBuffer.h>
+
+#include <array>
+#include <vector>
+
+
+using namespace ad::sounds;
+
+
+namespace {
+
+//Reads [aPosition, aPosition + aCount) through as many contiguous spans as needed
+std::vector<int> read(const RingBuffer<int> & aRing, std::size_t aPosition, std::size_t aCount)
+{
+    std::vector<int> values;
+    while (values.size() < aCount)
+    {
+        std::span<const int> span = aRing.getContiguous(aPosition, aCount - values.size());
+        if (span.empty())
+        {
+            break;
+        }
+        values.insert(values.end(), span.begin(), span.end());
+        aPosition += span.size();
+    }
+    return values;
+}
+
+} // anonymous namespace
+
+
+SCENARIO("Ring buffer wraps its samples around its capacity.")
+{
+    GIVEN("A ring of capacity 8 holding 6 samples.")
+    {
+        RingBuffer<int> ring{8};
+        const std::array<int, 6> first{0, 1, 2, 3, 4, 5};
+        ring.push(first.data(), first.size());
+
+        THEN("It holds them from position 0.")
+        {
+            REQUIRE(ring.getStart() == 0);
+            REQUIRE(ring.getEnd() == 6);
+            REQUIRE(ring.getFreeSpace() == 2);
+            REQUIRE(read(ring, 0, 6) == std::vector<int>{0, 1, 2, 3, 4, 5});
+        }
+
+        WHEN("Samples are consumed and more are pushed past the end of the storage.")
+        {
+            ring.consume(4);
+            const std::array<int, 5> second{6, 7, 8, 9, 10};
+            ring.push(second.data(), second.size());
+
+            THEN("Positions keep growing across the wrap point.")
+            {
+                REQUIRE(ring.getStart() == 4);
+                REQUIRE(ring.getEnd() == 11);
+                REQUIRE(ring.getSize() == 7);
+                REQUIRE(ring.getFreeSpace() == 1);
+            }
+
+            THEN("Contiguous spans stop at the wrap point.")
+            {
+                std::span<const int> beforeWrap = ring.getContiguous(4, 100);
+                REQUIRE(beforeWrap.size() == 4);
+                REQUIRE(beforeWrap.front() == 4);
+                REQUIRE(beforeWrap.back() == 7);
+
+                std::span<const int> afterWrap = ring.getContiguous(8, 100);
+                REQUIRE(afterWrap.size() == 3);
+                REQUIRE(afterWrap.front() == 8);
+                REQUIRE(afterWrap.back() == 10);
+            }
+
+            THEN("Every held sample reads back in order.")
+            {
+                REQUIRE(read(ring, 4, 7) == std::vector<int>{4, 5, 6, 7, 8, 9, 10});
+            }
+
+            THEN("Recycled and not yet pushed positions are not held.")
+            {
+                REQUIRE(ring.getContiguous(3, 1).empty());
+                REQUIRE(ring.getContiguous(11, 1).empty());
+            }
+        }
+
+        WHEN("The ring is consumed past its end.")
+        {
+            ring.consume(100);
+
+            THEN("It is empty at its end position.")
+            {
+                REQUIRE(ring.getStart() == 6);
+                REQUIRE(ring.getSize() == 0);
+                REQUIRE(ring.getFreeSpace() == 8);
+            }
+        }
+
+        WHEN("The ring is reset to a later position.")
+        {
+            ring.reset(20);
+            const std::array<int, 8> full{20, 21, 22, 23, 24, 25, 26, 27};
+            ring.push(full.data(), full.size());
+
+            THEN("It fills its whole capacity from there.")
+            {
+                REQUIRE(ring.getStart() == 20);
+                REQUIRE(ring.getEnd() == 28);
+                REQUIRE(ring.getFreeSpace() == 0);
+                REQUIRE(read(ring, 20, 8) == std::vector<int>{20, 21, 22, 23, 24, 25, 26, 27});
+                REQUIRE(ring.getContiguous(6, 1).empty());
+            }
+        }
+    }
+}
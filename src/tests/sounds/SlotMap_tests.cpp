@@ -0,0 +1,107 @@
+#include <catch2/catch.hpp>
+
+#include <sounds/SlotMap.h>
+
+#include <string>
+
+
+using namespace ad::sounds;
+
+
+SCENARIO("Slot map handles outlive the values they refer to.")
+{
+    GIVEN("A slot map holding two values.")
+    {
+        SlotMap<int, std::string> slotMap;
+        Handle<int> first = slotMap.insert("first");
+        Handle<int> second = slotMap.insert("second");
+
+        THEN("Both handles resolve to their value.")
+        {
+            REQUIRE(slotMap.size() == 2);
+            REQUIRE(*slotMap.find(first) == "first");
+            REQUIRE(*slotMap.find(second) == "second");
+        }
+
+        WHEN("The first value is erased.")
+        {
+            REQUIRE(slotMap.erase(first));
+
+            THEN("Its handle resolves to nothing and cannot erase again.")
+            {
+                REQUIRE_FALSE(slotMap.contains(first));
+                REQUIRE(slotMap.find(first) == nullptr);
+                REQUIRE_FALSE(slotMap.erase(first));
+            }
+
+            THEN("The last value moved in its place still resolves.")
+            {
+                REQUIRE(slotMap.size() == 1);
+                REQUIRE(*slotMap.find(second) == "second");
+            }
+
+            WHEN("A new value is inserted.")
+            {
+                Handle<int> third = slotMap.insert("third");
+
+                THEN("It reuses the slot with a new generation.")
+                {
+                    REQUIRE(third.mHandleIndex == first.mHandleIndex);
+                    REQUIRE(third.mGeneration != first.mGeneration);
+                    REQUIRE_FALSE(third == first);
+                }
+
+                THEN("The stale handle does not resolve to the new value.")
+                {
+                    REQUIRE(slotMap.find(first) == nullptr);
+                    REQUIRE(*slotMap.find(third) == "third");
+                    REQUIRE_FALSE(slotMap.erase(first));
+                    REQUIRE(slotMap.size() == 2);
+                }
+            }
+        }
+
+        WHEN("The slot map is cleared.")
+        {
+            slotMap.clear();
+
+            THEN("No handle resolves anymore, even once the slots are reused.")
+            {
+                REQUIRE(slotMap.empty());
+                REQUIRE(slotMap.find(first) == nullptr);
+                REQUIRE(slotMap.find(second) == nullptr);
+
+                Handle<int> reused = slotMap.insert("reused");
+                REQUIRE(slotMap.find(first) == nullptr);
+                REQUIRE(slotMap.find(second) == nullptr);
+                REQUIRE(*slotMap.find(reused) == "reused");
+            }
+        }
+    }
+
+    GIVEN("Two slot maps.")
+    {
+        SlotMap<int, int> slotMap;
+        SlotMap<int, int> otherMap;
+        Handle<int> handle = slotMap.insert(1);
+        otherMap.insert(2);
+
+        THEN("A handle only resolves in the map that made it.")
+        {
+            REQUIRE(slotMap.contains(handle));
+            REQUIRE_FALSE(otherMap.contains(handle));
+            REQUIRE(otherMap.find(handle) == nullptr);
+        }
+    }
+
+    GIVEN("A default constructed handle.")
+    {
+        SlotMap<int, int> slotMap;
+        slotMap.insert(1);
+
+        THEN("It resolves to nothing.")
+        {
+            REQUIRE(slotMap.find(Handle<int>{}) == nullptr);
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#include <catch2/catch.hpp>
+
+#include <sounds/SoundBank.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+using namespace ad::sounds;
+
+
+namespace {
+
+template<typename T>
+void writeInteger(std::vector<char> & aOutput, T aValue)
+{
+    for (std::size_t i = 0; i < sizeof(T); i++)
+    {
+        aOutput.push_back(static_cast<char>((aValue >> (8 * i)) & 0xff));
+    }
+}
+
+void writeHeader(std::vector<char> & aOutput, std::uint32_t aVersion, std::uint32_t aEntryCount)
+{
+    aOutput.insert(aOutput.end(), {'A', 'D', 'S', 'B'});
+    writeInteger(aOutput, aVersion);
+    writeInteger(aOutput, aEntryCount);
+}
+
+void writeEntry(
+        std::vector<char> & aOutput,
+        const std::string & aName,
+        std::uint64_t aOffset,
+        std::uint64_t aLength,
+        std::uint8_t aStorage = 0,
+        std::uint8_t aSampleFormat = 0)
+{
+    writeInteger(aOutput, static_cast<std::uint16_t>(aName.size()));
+    aOutput.insert(aOutput.end(), aName.begin(), aName.end());
+    writeInteger(aOutput, aOffset);
+    writeInteger(aOutput, aLength);
+    writeInteger(aOutput, std::uint16_t{2});
+    writeInteger(aOutput, std::uint32_t{44100});
+    writeInteger(aOutput, aStorage);
+    writeInteger(aOutput, aSampleFormat);
+}
+
+} // anonymous namespace
+
+
+SCENARIO("Sound bank index is parsed from the start of the bank.")
+{
+    GIVEN("A bank with two entries after its index.")
+    {
+        //Header, then per entry its fixed fields and its name
+        const std::uint64_t indexSize = 12 + (26 + 5) + (26 + 5);
+        std::vector<char> bank;
+        writeHeader(bank, 2, 2);
+        writeEntry(bank, "music", indexSize, 4, 1, 0);
+        writeEntry(bank, "click", indexSize + 4, 3, 2, SampleFormat_INT16 + 1);
+        REQUIRE(bank.size() == indexSize);
+        bank.insert(bank.end(), {'o', 'g', 'g', 's', 'o', 'g', 'g'});
+
+        WHEN("Its index is read.")
+        {
+            std::vector<SoundBankEntry> entries;
+            REQUIRE(readSoundBankIndex(bank, entries));
+
+            THEN("Every entry is described.")
+            {
+                REQUIRE(entries.size() == 2);
+
+                CHECK(entries[0].name == "music");
+                CHECK(entries[0].offset == indexSize);
+                CHECK(entries[0].length == 4);
+                CHECK(entries[0].channels == 2);
+                CHECK(entries[0].sampleRate == 44100);
+                CHECK(entries[0].streamed);
+                CHECK_FALSE(entries[0].compressed);
+                CHECK_FALSE(entries[0].sampleFormat.has_value());
+
+                CHECK(entries[1].name == "click");
+                CHECK(entries[1].offset == indexSize + 4);
+                CHECK(entries[1].length == 3);
+                CHECK_FALSE(entries[1].streamed);
+                CHECK(entries[1].compressed);
+                CHECK(entries[1].sampleFormat == SampleFormat_INT16);
+            }
+        }
+
+        WHEN("The bank is cut in its last sound.")
+        {
+            bank.pop_back();
+            std::vector<SoundBankEntry> entries;
+
+            THEN("It is rejected.")
+            {
+                REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+            }
+        }
+
+        WHEN("The bank is cut in its index.")
+        {
+            bank.resize(indexSize - 1);
+            std::vector<SoundBankEntry> entries;
+
+            THEN("It is rejected.")
+            {
+                REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+            }
+        }
+    }
+
+    GIVEN("Malformed banks.")
+    {
+        std::vector<SoundBankEntry> entries;
+
+        THEN("A wrong magic is rejected.")
+        {
+            std::vector<char> bank{'O', 'g', 'g', 'S'};
+            writeInteger(bank, std::uint32_t{2});
+            writeInteger(bank, std::uint32_t{0});
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+
+        THEN("A bank shorter than its magic is rejected.")
+        {
+            std::vector<char> bank{'A', 'D'};
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+
+        THEN("Another version is rejected.")
+        {
+            std::vector<char> bank;
+            writeHeader(bank, 1, 0);
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+
+        THEN("An entry count beyond the index is rejected.")
+        {
+            std::vector<char> bank;
+            writeHeader(bank, 2, 1000);
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+
+        THEN("A name longer than the index is rejected.")
+        {
+            std::vector<char> bank;
+            writeHeader(bank, 2, 1);
+            writeInteger(bank, std::uint16_t{100});
+            bank.insert(bank.end(), {'a', 'b'});
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+
+        THEN("An unknown storage is rejected.")
+        {
+            std::vector<char> bank;
+            writeHeader(bank, 2, 1);
+            writeEntry(bank, "a", 0, 0, 3);
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+
+        THEN("An unknown sample format is rejected.")
+        {
+            std::vector<char> bank;
+            writeHeader(bank, 2, 1);
+            writeEntry(bank, "a", 0, 0, 0, SampleFormat_INT16 + 2);
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+
+        THEN("An entry whose end overflows is rejected.")
+        {
+            std::vector<char> bank;
+            writeHeader(bank, 2, 1);
+            writeEntry(bank, "a", 8, static_cast<std::uint64_t>(-1));
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+
+        THEN("An entry starting past the bank is rejected.")
+        {
+            std::vector<char> bank;
+            writeHeader(bank, 2, 1);
+            writeEntry(bank, "a", 1000, 0);
+            REQUIRE_FALSE(readSoundBankIndex(bank, entries));
+        }
+    }
+
+    GIVEN("A bank without entries.")
+    {
+        std::vector<char> bank;
+        writeHeader(bank, 2, 0);
+        std::vector<SoundBankEntry> entries;
+
+        THEN("It is read as empty.")
+        {
+            REQUIRE(readSoundBankIndex(bank, entries));
+            REQUIRE(entries.empty());
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#define CATCH_CONFIG_RUNNER
+#include <catch2/catch.hpp>
+
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+
+int main(int argc, char * argv[])
+{
+    //The library logs to the sounds logger, rejected inputs log errors
+    spdlog::stdout_color_mt("sounds");
+    spdlog::get("sounds")->set_level(spdlog::level::off);
+
+    return Catch::Session().run(argc, argv);
+}